@@ -1,36 +1,40 @@
 #include "MultiThreadProgress.hpp"
 
-ProgressStatus* MultiThreadProgress::RequestRegister()
+void MultiThreadProgress::AddProgressBar(const std::shared_ptr<ProgressSlot>& slot)
 {
-	ThreadProgressBars.Append(new ProgressStatus(&ContentArea));
+	ThreadProgressBars.Append(new ProgressStatus(slot, &ContentArea));
 	ProgressStatus* newProgressBar = ThreadProgressBars[ThreadProgressBars.GetLastArrayIndex()];
 
 	AddWidget(newProgressBar);
-
-	return newProgressBar;
 }
 
-void MultiThreadProgress::RequestUnregister(ProgressStatus* progressBar)
+void MultiThreadProgress::RemoveProgressBar(ProgressSlot* slot)
 {
-	RemoveWidget(progressBar);
-
-	ThreadProgressBars.ObjectRemove(progressBar);
+	for (ProgressStatus* progressBar : ThreadProgressBars)
+	{
+		if (progressBar->GetSlot() != slot)
+		{
+			continue;
+		}
+
+		ThreadProgressBars.ObjectRemove(progressBar);
+		RemoveWidget(progressBar);
+		return;
+	}
 }
 
-ProgressStatus* MultiThreadProgress::RegisterProgressBar()
+std::shared_ptr<ProgressSlot> MultiThreadProgress::RegisterProgressBar()
 {
-	ProgressStatus* returnProgressStatus = nullptr;
-	QMetaObject::invokeMethod(this, "RequestRegister", Qt::BlockingQueuedConnection, Q_RETURN_ARG(ProgressStatus*, returnProgressStatus));
+	std::shared_ptr<ProgressSlot> slot = std::make_shared<ProgressSlot>();
 
-	if (returnProgressStatus == nullptr)
-	{
-		NosLib::Logging::CreateLog<wchar_t>(L"RegisterProgressBar returned a nullptr", NosLib::Logging::Severity::Error);
-	}
+	/* queued, so the worker never waits on the GUI thread. Events run in order, so a removal can't overtake its add */
+	QMetaObject::invokeMethod(this, [this, slot]() { AddProgressBar(slot); }, Qt::QueuedConnection);
 
-	return returnProgressStatus;
+	return slot;
 }
 
-void MultiThreadProgress::UnregisterProgressBar(ProgressStatus* progressBar)
+void MultiThreadProgress::UnregisterProgressBar(const std::shared_ptr<ProgressSlot>& slot)
 {
-	QMetaObject::invokeMethod(this, "RequestUnregister", Qt::BlockingQueuedConnection, Q_ARG(ProgressStatus*, progressBar));
-}
\ No newline at end of file
+	ProgressSlot* slotPointer = slot.get();
+	QMetaObject::invokeMethod(this, [this, slotPointer]() { RemoveProgressBar(slotPointer); }, Qt::QueuedConnection);
+}
@@ -12,10 +12,12 @@
 #include <QPropertyAnimation>
 #include <QProgressBar>
 #include <QLabel>
+#include <QTimer>
 
 #include "FlowLayout.hpp"
+#include "../Headers/ProgressSink.hpp"
 
-#include <mutex>
+#include <memory>
 
 class ProgressStatus : public QFrame
 {
@@ -26,9 +28,15 @@ private:
 	QLabel StatusLabel;
 	QVBoxLayout ContainerLayout;
 
+	std::shared_ptr<ProgressSlot> Slot; /* shared with the worker, whichever lets go last frees it */
+	uint32_t SeenStatusVersion = 0;
+	int ShownPercentage = 0;
+
 public:
-	inline ProgressStatus(QWidget* parent = nullptr) : QFrame(parent)
+	inline ProgressStatus(const std::shared_ptr<ProgressSlot>& slot, QWidget* parent = nullptr) : QFrame(parent)
 	{
+		Slot = slot;
+
 		setFrameShape(QFrame::Shape::Box);
 		setFrameShadow(QFrame::Shadow::Raised);
 
@@ -49,19 +57,32 @@ public:
 		setLayout(&ContainerLayout);
 	}
 
-public slots:
-	void UpdateProgress(const int& value)
+	ProgressSlot* GetSlot()
 	{
-		ProgressBar.setValue(value);
+		return Slot.get();
 	}
 
-	void UpdateStatus(const std::wstring& value)
+	/* GUI thread only */
+	void Refresh()
 	{
-		StatusLabel.setText(QString::fromStdWString(value));
+		int percentage = Slot->GetPercentage();
+		if (percentage != ShownPercentage)
+		{
+			/* unknown total, maximum of 0 makes the bar show that it's busy */
+			ProgressBar.setMaximum(percentage < 0 ? 0 : 100);
+			ProgressBar.setValue(percentage < 0 ? 0 : percentage);
+			ShownPercentage = percentage;
+		}
+
+		std::wstring status;
+		if (Slot->GetStatusIfChanged(&SeenStatusVersion, &status))
+		{
+			StatusLabel.setText(QString::fromStdWString(status));
+		}
 	}
 };
 
-class MultiThreadProgress : public QWidget
+class MultiThreadProgress : public QWidget, public ProgressSink
 {
 	Q_OBJECT
 
@@ -74,13 +95,13 @@ private:
 	FlowLayout ContentLayout;
 	int AnimationDuration = 300;
 
-	inline static std::mutex registerMutex;
+	QTimer RefreshTimer;
+	inline static constexpr int RefreshInterval = 50; /* ms, workers never touch the widgets. Their progress gets picked up at 20Hz instead */
 
-	NosLib::DynamicArray<ProgressStatus*> ThreadProgressBars;
+	NosLib::DynamicArray<ProgressStatus*> ThreadProgressBars; /* GUI thread only */
 
-private slots:
-	ProgressStatus* RequestRegister();
-	void RequestUnregister(ProgressStatus* progressBar);
+	void AddProgressBar(const std::shared_ptr<ProgressSlot>& slot);
+	void RemoveProgressBar(ProgressSlot* slot);
 
 public:
 	inline MultiThreadProgress(QWidget* parent = nullptr, const QString& title = "MultiThreaded Progress") : QWidget(parent)
@@ -125,22 +146,43 @@ public:
 		ContentLayout.setSpacing(5);
 		ContentLayout.setContentsMargins(5, 5, 5, 5);
 		ContentArea.setLayout(&ContentLayout);
+
+		RefreshTimer.setInterval(RefreshInterval);
+		QObject::connect(&RefreshTimer, &QTimer::timeout, this, &MultiThreadProgress::RefreshProgressBars);
+		RefreshTimer.start();
 	}
 
-	ProgressStatus* RegisterProgressBar();
-	void UnregisterProgressBar(ProgressStatus* progressBar);
+	/// <summary>
+	/// hands out a progress slot straight away, its progress bar gets created once the GUI thread gets to it. Safe to call from any thread
+	/// </summary>
+	/// <returns>the slot to write progress into</returns>
+	std::shared_ptr<ProgressSlot> RegisterProgressBar() override;
+
+	/// <summary>
+	/// removes the progress bar of the slot once the GUI thread gets to it, doesn't wait for it
+	/// </summary>
+	void UnregisterProgressBar(const std::shared_ptr<ProgressSlot>& slot) override;
 
 protected:
+	inline void RefreshProgressBars()
+	{
+		for (ProgressStatus* progressBar : ThreadProgressBars)
+		{
+			progressBar->Refresh();
+		}
+	}
+
 	inline void AddWidget(QWidget* newWidget)
 	{
 		QLayout* contentLayout = ContentArea.layout();
 		contentLayout->addWidget(newWidget);
 	}
 
-	inline void RemoveWidget(QWidget* newWidget)
+	inline void RemoveWidget(QWidget* oldWidget)
 	{
 		QLayout* contentLayout = ContentArea.layout();
-		contentLayout->addWidget(newWidget);
+		contentLayout->removeWidget(oldWidget);
+		oldWidget->deleteLater();
 	}
 
 	inline void UpdateAnimation()
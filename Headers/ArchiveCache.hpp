@@ -0,0 +1,95 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+
+/// <summary>
+/// Keeps downloaded archives between installs. Archives are stored by content hash (so the same archive behind 2 links is stored once),
+/// a small index maps each link to the version it was downloaded as. Least recently used archives get removed once the cache goes over its size limit
+/// </summary>
+class ArchiveCache
+{
+public:
+	struct Entry
+	{
+		std::wstring Url;			/* the mod link */
+		std::string ETag;
+		std::string LastModified;
+		uint64_t ContentLength = 0;
+		std::wstring FileExtension;
+		std::string Hash;			/* XXH64 of the archive, also the name it is stored under */
+		uint64_t LastUsed = 0;		/* seconds since epoch */
+
+		/// <summary>
+		/// checks if the entry is the same version of the file the server has now
+		/// </summary>
+		bool Matches(const std::string& eTag, const std::string& lastModified, const uint64_t& contentLength) const;
+	};
+
+protected:
+	inline static std::mutex CacheMutex;
+	inline static std::wstring CacheDirectory;
+	inline static uint64_t SizeLimit = 0;
+	inline static bool Enabled = false;
+
+	inline static std::unordered_map<std::wstring, Entry> Entries; /* by Url */
+
+public:
+	/// <summary>
+	/// enables the cache and loads its index
+	/// </summary>
+	/// <param name="cacheDirectory">- where archives get stored, empty uses the default directory</param>
+	/// <param name="sizeLimit">- size in bytes the cache gets trimmed down to</param>
+	static void Initialize(const std::wstring& cacheDirectory, const uint64_t& sizeLimit);
+
+	static bool IsEnabled()
+	{
+		return Enabled;
+	}
+
+	/// <returns>per user directory, "%LOCALAPPDATA%\NorzkasGammaInstaller\ArchiveCache\" on windows</returns>
+	static std::wstring GetDefaultDirectory();
+
+	/// <summary>
+	/// looks up the archive last stored for a link
+	/// </summary>
+	/// <param name="url">- the mod link</param>
+	/// <param name="entry">- gets set to the found entry</param>
+	/// <returns>true if the link has an archive in the cache</returns>
+	static bool Find(const std::wstring& url, Entry* entry);
+
+	/// <summary>
+	/// puts a cached archive at <paramref name="targetPath"/> (hardlinked if possible, copied if not)
+	/// </summary>
+	/// <returns>true if successful</returns>
+	static bool Restore(const Entry& entry, const std::wstring& targetPath);
+
+	/// <summary>
+	/// adds a downloaded archive to the cache, replacing whatever was stored for the link before
+	/// </summary>
+	/// <param name="entry">- what was downloaded (Hash and LastUsed get filled in)</param>
+	/// <param name="filePath">- the downloaded archive</param>
+	/// <returns>true if successful</returns>
+	static bool Store(Entry entry, const std::wstring& filePath);
+
+	/// <summary>
+	/// adds an archive which was downloaded into memory to the cache
+	/// </summary>
+	static bool Store(Entry entry, const std::vector<unsigned char>& buffer);
+
+protected:
+	static std::wstring GetObjectPath(const Entry& entry);
+	static std::wstring GetIndexPath();
+
+	/// <summary>
+	/// records the entry, trims the cache and saves the index. Needs CacheMutex
+	/// </summary>
+	static void AddEntry(const Entry& entry);
+	static void Evict();
+
+	static void LoadIndex();
+	static bool SaveIndex();
+};
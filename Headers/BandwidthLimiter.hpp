@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+/// <summary>
+/// Token buckets shared by every download, 1 global and 1 per host with its own rate. Downloads take tokens for what they received
+/// and wait once the bucket runs dry, which slows the reading down so the connection stays usable for everything else.
+/// Rates can be changed at any time and apply to downloads already running
+/// </summary>
+class BandwidthLimiter
+{
+public:
+	/* global rate used between StartHour and EndHour (local time, wraps over midnight if EndHour is smaller) */
+	struct ScheduleWindow
+	{
+		int StartHour;
+		int EndHour;
+		uint64_t BytesPerSecond; /* 0 means unlimited */
+
+		bool Contains(const int& hour) const;
+	};
+
+protected:
+	struct Bucket
+	{
+		std::mutex BucketMutex;
+		uint64_t Rate;	/* bytes per second, 0 means unlimited */
+		double Tokens;
+		std::chrono::steady_clock::time_point LastRefill;
+
+		Bucket() : Rate(0), Tokens(0), LastRefill(std::chrono::steady_clock::now()) {}
+	};
+
+	inline static constexpr double BurstSeconds = 0.25;								/* how much unused rate can be saved up */
+	inline static constexpr std::chrono::milliseconds MaxWaitSlice = std::chrono::milliseconds(100);	/* waits are split up so rate changes apply quickly */
+
+	inline static std::mutex LimiterMutex;
+	inline static uint64_t GlobalRate = 0;
+	inline static std::vector<ScheduleWindow> Schedule;
+	inline static Bucket GlobalBucket;
+	inline static std::unordered_map<std::string, std::unique_ptr<Bucket>> HostBuckets; /* by host url */
+
+public:
+	/// <summary>
+	/// sets the rate for all downloads together, used whenever no schedule window applies
+	/// </summary>
+	/// <param name="bytesPerSecond">- 0 means unlimited</param>
+	static void SetGlobalRate(const uint64_t& bytesPerSecond);
+
+	static uint64_t GetGlobalRate();
+
+	/// <summary>
+	/// sets the rate for downloads from 1 host, on top of the global rate
+	/// </summary>
+	/// <param name="hostUrl">- scheme + host, example "https://www.moddb.com"</param>
+	/// <param name="bytesPerSecond">- 0 means unlimited</param>
+	static void SetHostRate(const std::string& hostUrl, const uint64_t& bytesPerSecond);
+
+	/// <summary>
+	/// replaces the schedule, the first window containing the current hour overrides the global rate. Example: {0, 7, 0} for full speed overnight
+	/// </summary>
+	static void SetSchedule(const std::vector<ScheduleWindow>& schedule);
+
+	/// <summary>
+	/// takes <paramref name="bytes"/> out of the global and host bucket, waiting until both allow it
+	/// </summary>
+	/// <param name="hostUrl">- host the bytes came from</param>
+	/// <param name="bytes">- amount of bytes received</param>
+	static void Consume(const std::string& hostUrl, const uint64_t& bytes);
+
+protected:
+	static uint64_t GetEffectiveGlobalRate();
+	static Bucket* FindHostBucket(const std::string& hostUrl);
+	static void ConsumeFrom(Bucket* bucket, const uint64_t& rate, const uint64_t& bytes);
+};
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+/// <summary>
+/// Lock-free multi producer, multi consumer queue with a fixed capacity (bounded ring buffer with a sequence number per cell).
+/// Push blocks while it is full and Pop blocks while it is empty, waiting is done on atomics so the hot path never takes a lock
+/// </summary>
+template <class Type>
+class BoundedQueue
+{
+protected:
+	struct Cell
+	{
+		std::atomic<size_t> Sequence;
+		Type Item;
+	};
+
+	std::unique_ptr<Cell[]> Cells;
+	size_t Mask;
+
+	/* kept on separate cache lines, producers and consumers would otherwise fight over the same line */
+	alignas(64) std::atomic<size_t> EnqueuePosition = 0;
+	alignas(64) std::atomic<size_t> DequeuePosition = 0;
+
+	/* bumped on every push/pop, blocked threads wait for these to change */
+	alignas(64) std::atomic<uint32_t> PushEvents = 0;
+	alignas(64) std::atomic<uint32_t> PopEvents = 0;
+	std::atomic<bool> Closed = false;
+
+public:
+	BoundedQueue(const size_t& capacity)
+	{
+		/* capacity gets rounded up to a power of 2, so positions can be wrapped with a mask */
+		size_t cellCount = 2;
+		while (cellCount < capacity)
+		{
+			cellCount <<= 1;
+		}
+
+		Cells = std::make_unique<Cell[]>(cellCount);
+		Mask = cellCount - 1;
+
+		for (size_t i = 0; i < cellCount; i++)
+		{
+			Cells[i].Sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	/// <summary>
+	/// adds an item if there is space
+	/// </summary>
+	/// <returns>false if the queue is full</returns>
+	bool TryPush(const Type& item)
+	{
+		Cell* cell;
+		size_t position = EnqueuePosition.load(std::memory_order_relaxed);
+
+		while (true)
+		{
+			cell = &Cells[position & Mask];
+			size_t sequence = cell->Sequence.load(std::memory_order_acquire);
+			intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+			if (difference == 0)
+			{
+				if (EnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (difference < 0)
+			{
+				return false;
+			}
+			else
+			{
+				position = EnqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		cell->Item = item;
+		cell->Sequence.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	/// <summary>
+	/// takes the oldest item if there is one
+	/// </summary>
+	/// <returns>false if the queue is empty</returns>
+	bool TryPop(Type* item)
+	{
+		Cell* cell;
+		size_t position = DequeuePosition.load(std::memory_order_relaxed);
+
+		while (true)
+		{
+			cell = &Cells[position & Mask];
+			size_t sequence = cell->Sequence.load(std::memory_order_acquire);
+			intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+
+			if (difference == 0)
+			{
+				if (DequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (difference < 0)
+			{
+				return false;
+			}
+			else
+			{
+				position = DequeuePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		*item = cell->Item;
+		cell->Sequence.store(position + Mask + 1, std::memory_order_release);
+		return true;
+	}
+
+	/// <summary>
+	/// adds an item, waiting for space if the queue is full
+	/// </summary>
+	/// <returns>false if the queue was closed</returns>
+	bool Push(const Type& item)
+	{
+		while (true)
+		{
+			uint32_t observedPops = PopEvents.load(std::memory_order_acquire);
+
+			if (Closed.load(std::memory_order_acquire))
+			{
+				return false;
+			}
+
+			if (TryPush(item))
+			{
+				PushEvents.fetch_add(1, std::memory_order_release);
+				PushEvents.notify_one();
+				return true;
+			}
+
+			PopEvents.wait(observedPops, std::memory_order_acquire);
+		}
+	}
+
+	/// <summary>
+	/// takes the oldest item, waiting for one if the queue is empty
+	/// </summary>
+	/// <returns>false once the queue is closed and empty</returns>
+	bool Pop(Type* item)
+	{
+		while (true)
+		{
+			uint32_t observedPushes = PushEvents.load(std::memory_order_acquire);
+
+			if (TryPop(item))
+			{
+				PopEvents.fetch_add(1, std::memory_order_release);
+				PopEvents.notify_one();
+				return true;
+			}
+
+			if (Closed.load(std::memory_order_acquire))
+			{
+				return false;
+			}
+
+			PushEvents.wait(observedPushes, std::memory_order_acquire);
+		}
+	}
+
+	/// <summary>
+	/// no more items will be pushed, consumers drain what is left and then stop
+	/// </summary>
+	void Close()
+	{
+		Closed.store(true, std::memory_order_release);
+
+		PushEvents.fetch_add(1, std::memory_order_release);
+		PushEvents.notify_all();
+		PopEvents.fetch_add(1, std::memory_order_release);
+		PopEvents.notify_all();
+	}
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <NosLib/HttpClient.hpp>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+/// <summary>
+/// Keeps idle http clients per host between downloads. A client which gets handed back keeps its connection open (keep-alive),
+/// so the next download from the same host skips the DNS lookup, TCP handshake and TLS handshake
+/// </summary>
+class ConnectionPool
+{
+public:
+	/// <summary>
+	/// a client borrowed from the pool, goes back to the pool once the lease is destroyed
+	/// </summary>
+	class Lease
+	{
+	protected:
+		NosLib::HttpClient::ptr Client;
+		std::string PoolKey;
+
+	public:
+		Lease() {}
+
+		Lease(NosLib::HttpClient::ptr&& client, const std::string& poolKey)
+		{
+			Client = std::move(client);
+			PoolKey = poolKey;
+		}
+
+		Lease(Lease&& other) noexcept
+		{
+			Client = std::move(other.Client);
+			PoolKey = std::move(other.PoolKey);
+		}
+
+		Lease& operator=(Lease&& other) noexcept
+		{
+			if (this != &other)
+			{
+				Release();
+				Client = std::move(other.Client);
+				PoolKey = std::move(other.PoolKey);
+			}
+
+			return *this;
+		}
+
+		Lease(const Lease&) = delete;
+		Lease& operator=(const Lease&) = delete;
+
+		~Lease()
+		{
+			Release();
+		}
+
+		httplib::Client* get() const
+		{
+			return Client.get();
+		}
+
+		httplib::Client* operator->() const
+		{
+			return Client.get();
+		}
+
+		bool operator==(std::nullptr_t) const
+		{
+			return Client == nullptr;
+		}
+
+		/* hands the client back early */
+		void Release();
+	};
+
+protected:
+	inline static constexpr size_t MaxIdlePerHost = 8; /* enough for every segment of a ranged download plus a few */
+
+	inline static std::mutex PoolMutex;
+	inline static std::unordered_map<std::string, std::vector<NosLib::HttpClient::ptr>> IdleClients; /* by pool key */
+
+	inline static std::atomic<uint64_t> ClientsCreated = 0;
+	inline static std::atomic<uint64_t> HandshakesSaved = 0;
+
+public:
+	/// <summary>
+	/// borrows an idle client for <paramref name="hostUrl"/>, or creates a new one if all of them are in use
+	/// </summary>
+	/// <param name="hostUrl">- scheme + host, example "https://www.moddb.com"</param>
+	/// <param name="followLocation">- if the client follows redirects, clients with and without are kept apart</param>
+	/// <returns>the lease, the client goes back to the pool once it's destroyed</returns>
+	static Lease Acquire(const std::string& hostUrl, const bool& followLocation = true);
+
+	/// <summary>
+	/// closes and removes every idle client
+	/// </summary>
+	static void Clear();
+
+	/// <returns>amount of clients created, which each needed their own connection</returns>
+	static uint64_t GetClientsCreated()
+	{
+		return ClientsCreated.load();
+	}
+
+	/// <returns>amount of times an idle client with an open connection got reused, each one is a DNS lookup + TCP + TLS handshake saved</returns>
+	static uint64_t GetHandshakesSaved()
+	{
+		return HandshakesSaved.load();
+	}
+
+protected:
+	static void Return(const std::string& poolKey, NosLib::HttpClient::ptr&& client);
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "ProgressSink.hpp"
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+/// <summary>
+/// Writes worker statuses and the overall estimate to stdout, as readable text or as 1 JSON object per line for scripts.
+/// Nothing is printed from the workers themselves, a reporting thread samples the slots every interval
+/// </summary>
+class ConsoleProgressSink : public ProgressSink
+{
+public:
+	enum class Format
+	{
+		Text,
+		Json,
+	};
+
+protected:
+	struct WorkerEntry
+	{
+		int Id;
+		std::shared_ptr<ProgressSlot> Slot;
+		uint32_t SeenStatusVersion = 0;
+	};
+
+	Format OutputFormat;
+	std::chrono::milliseconds Interval;
+
+	std::mutex SinkMutex;
+	std::vector<WorkerEntry> Workers;
+	int NextWorkerId = 0;
+	bool Estimating = false; /* InstallEstimator only has something to say once the install is initialized */
+
+	std::thread ReportThread;
+	std::condition_variable StopSignal;
+	bool Stopping = false;
+
+public:
+	ConsoleProgressSink(const Format& outputFormat, const std::chrono::milliseconds& interval = std::chrono::milliseconds(1000));
+	~ConsoleProgressSink();
+
+	std::shared_ptr<ProgressSlot> RegisterProgressBar() override;
+	void UnregisterProgressBar(const std::shared_ptr<ProgressSlot>& slot) override;
+
+	/// <summary>
+	/// starts printing the overall progress, call once the install finished initializing
+	/// </summary>
+	void StartEstimate();
+
+	/// <summary>
+	/// stops the reporting thread and prints the last report
+	/// </summary>
+	/// <param name="timeTaken">- how long the install took, as shown to the user</param>
+	void Finish(const std::wstring& timeTaken);
+
+protected:
+	void ReportLoop();
+	void Report();
+	void Print(const std::string& line);
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+/// <summary>
+/// Sidecar of a ".part" download, remembers what was being downloaded and how much of it is safely on disk, so it can be continued with ranged requests
+/// </summary>
+class DownloadState
+{
+public:
+	struct Segment
+	{
+		uint64_t Start;		/* first byte of the segment */
+		uint64_t End;		/* last byte of the segment (inclusive) */
+		uint64_t Committed;	/* bytes from Start which have been flushed to disk */
+
+		uint64_t GetResumeOffset() const
+		{
+			return Start + Committed;
+		}
+
+		bool IsComplete() const
+		{
+			return GetResumeOffset() > End;
+		}
+	};
+
+	std::wstring Url;			/* the original link (mirror links change, the mod link doesn't) */
+	std::string ETag;
+	std::string LastModified;
+	std::wstring FileExtension;
+	uint64_t ContentLength = 0;
+	std::vector<Segment> Segments;
+
+protected:
+	std::mutex StateMutex;
+
+public:
+	DownloadState() {}
+
+	/// <summary>
+	/// splits the file into even segments, throwing away anything that was committed
+	/// </summary>
+	/// <param name="segmentCount">- amount of segments to split into</param>
+	void PlanSegments(const int& segmentCount);
+
+	/// <summary>
+	/// checks if the state describes the same version of the same file
+	/// </summary>
+	bool Matches(const std::wstring& url, const std::string& eTag, const std::string& lastModified, const uint64_t& contentLength);
+
+	uint64_t GetCommittedBytes();
+
+	/// <summary>
+	/// records that the segment has <paramref name="committed"/> bytes on disk and saves the state
+	/// </summary>
+	void Commit(const size_t& segmentIndex, const uint64_t& committed, const std::wstring& statePath);
+
+	bool Load(const std::wstring& statePath);
+	bool Save(const std::wstring& statePath);
+
+	static void Remove(const std::wstring& statePath);
+};
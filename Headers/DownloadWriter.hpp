@@ -0,0 +1,78 @@
+#pragma once
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+/// <summary>
+/// Writes a download to disk in large blocks instead of once per (usually 16KB) httplib chunk.
+/// The file gets its full size reserved up front, so it doesn't fragment while growing chunk by chunk
+/// </summary>
+class DownloadWriter
+{
+protected:
+	inline static constexpr size_t BufferSize = 4 * 1024 * 1024;
+	inline static constexpr size_t MinBufferSize = 256 * 1024; /* what a writer gets once the budget is used up */
+	inline static constexpr uint64_t TotalBufferLimit = 64ull * 1024 * 1024; /* every download and every segment has a writer, together they get this much */
+	inline static std::atomic<uint64_t> TotalBuffered = 0;
+
+	std::ofstream Stream;
+	std::vector<char> Buffer;
+	size_t Buffered = 0;
+	uint64_t Written = 0; /* bytes given to Write, including the ones still in the buffer */
+
+public:
+	DownloadWriter() {}
+
+	DownloadWriter(const DownloadWriter&) = delete;
+	DownloadWriter& operator=(const DownloadWriter&) = delete;
+
+	~DownloadWriter()
+	{
+		Close();
+	}
+
+	/// <summary>
+	/// creates (or replaces) a file with <paramref name="size"/> bytes of disk space reserved for it
+	/// </summary>
+	/// <param name="path">- file to create</param>
+	/// <param name="size">- full size of the download, 0 if unknown (creates an empty file)</param>
+	/// <returns>true if successful</returns>
+	static bool Preallocate(const std::wstring& path, const uint64_t& size);
+
+	/// <summary>
+	/// opens an existing file (see Preallocate) for writing from <paramref name="offset"/>, without truncating it
+	/// </summary>
+	/// <param name="path">- file to write into</param>
+	/// <param name="offset">- where the first written byte goes</param>
+	/// <returns>true if successful</returns>
+	bool Open(const std::wstring& path, const uint64_t& offset);
+
+	/// <summary>
+	/// buffers the data, only writes to the file once the buffer is full
+	/// </summary>
+	/// <returns>false if writing to the file failed</returns>
+	bool Write(const char* data, const size_t& length);
+
+	/// <summary>
+	/// writes everything buffered to the file
+	/// </summary>
+	/// <returns>false if writing to the file failed</returns>
+	bool Flush();
+
+	/// <returns>false if anything failed to be written</returns>
+	bool Close();
+
+	uint64_t GetWritten() const
+	{
+		return Written;
+	}
+
+protected:
+	/// <summary>
+	/// takes a buffer size out of TotalBufferLimit, BufferSize if enough is left
+	/// </summary>
+	static size_t ReserveBuffer();
+};
@@ -7,14 +7,18 @@
 
 #include <bit7z\bit7z.hpp>
 #include <bit7z\bit7zlibrary.hpp>
-#include <bit7z\bitfileextractor.hpp>
+#include <bit7z\bitarchivereader.hpp>
 
 #include "ModDB.hpp"
+#include "ArchiveCache.hpp"
+#include "ConnectionPool.hpp"
 
 #include <string>
 #include <functional>
 #include <filesystem>
 #include <atomic>
+#include <vector>
+#include <memory>
 
 class ModInfo;
 
@@ -23,6 +27,26 @@ class File
 public:
 	using Status = void(ModInfo::*)(const std::wstring&);
 	using Progress = bool(ModInfo::*)(uint64_t, uint64_t);
+
+	/* where a user of the file wants an inner path of the archive to end up */
+	struct ExtractTarget
+	{
+		std::wstring InsidePath;	/* path inside the archive */
+		bool Recursive;				/* false only takes the files directly inside InsidePath */
+		std::wstring Destination;	/* directory the matching items get written into */
+	};
+
+	/* what the server identifies a version of the file by, for telling if it changed since it was downloaded */
+	struct Version
+	{
+		std::string ETag;
+		std::string LastModified;
+
+		bool IsKnown() const
+		{
+			return !ETag.empty() || !LastModified.empty();
+		}
+	};
 protected:
 	struct FileStore
 	{
@@ -53,8 +77,37 @@ protected:
 		Unknown,
 	};
 
+	/* What the server told us about the file before downloading it */
+	struct RemoteFileInfo
+	{
+		std::string HostUrl;		/* scheme + host of the final location (after redirects) */
+		std::string Path;			/* path of the final location */
+		std::string ContentType;
+		std::string ETag;
+		std::string LastModified;
+		uint64_t ContentLength = 0;
+		bool AcceptsRanges = false;
+		bool NotModified = false;	/* server answered a conditional request with "304 Not Modified" */
+	};
+
+	inline static constexpr uint64_t SegmentedDownloadThreshold = 64ull * 1024 * 1024; /* files smaller than this aren't worth splitting */
+	inline static constexpr int DownloadSegmentCount = 6;
+	inline static constexpr uint64_t CommitInterval = 8ull * 1024 * 1024; /* how often (in bytes) a segment saves its progress to the download state */
+	inline static constexpr int DownloadAttempts = 3;
+	/* an inner path of the archive which a user of the file needs */
+	struct ExtractRule
+	{
+		std::wstring Prefix;	/* normalized archive path, empty means the archive root */
+		bool Recursive;			/* false only takes the files directly inside Prefix */
+
+		bool Matches(const std::wstring& itemPath) const;
+	};
+
+	inline static constexpr uint64_t InMemoryDownloadThreshold = 64ull * 1024 * 1024; /* archives smaller than this get downloaded into memory and extracted from there */
+	inline static constexpr uint64_t InMemoryTotalLimit = 512ull * 1024 * 1024; /* every download starts at once and direct installs hold their archive until the last user is done, past this many bytes in memory downloads go to the disk instead */
+	inline static std::atomic<uint64_t> InMemoryBytes = 0;
+
 	inline static bit7z::Bit7zLibrary lib = bit7z::Bit7zLibrary(L"7z.dll"); /* Load 7z.dll into a class */
-	bit7z::BitFileExtractor extractor = bit7z::BitFileExtractor(lib); /* create extractor object */
 
 	static NosLib::HashTable<std::wstring, File*> fileHastTable;
 
@@ -65,9 +118,27 @@ protected:
 	FileStore FileName;
 
 	std::atomic<bool> Processing = false;
+	std::atomic<bool> Claimed = false;
+	std::atomic<bool> Downloaded = false;
 	std::atomic<bool> Extracted = false;
+	std::atomic<bool> Failed = false;
+	std::atomic<bool> DirectInstall = false; /* archive wasn't extracted, users write their items straight from it into their destination */
 	std::atomic<int> UsageCount;
 
+	/* what the InstallEstimator was told about the download so far */
+	bool DownloadSizeCounted = false;
+	uint64_t CountedDownloadSize = 0;
+	std::atomic<uint64_t> CountedDownloadBytes = 0;
+
+	Version DownloadedVersion; /* empty until downloaded (or restored from the archive cache) */
+
+	std::vector<bit7z::byte_t> ArchiveBuffer; /* whole archive, if it was downloaded into memory */
+	bool InMemory = false;
+	uint64_t MemoryReserved = 0; /* this file's part of InMemoryBytes */
+
+	std::vector<ExtractRule> ExtractRules;	/* union of what every user needs, nothing else gets extracted. empty means everything */
+	std::vector<bool> ExtractedItems;		/* archive items already in the extract directory, by item index */
+
 	ModInfo* CallerPointer = nullptr;
 	Status StatusCallback;
 	Progress ProgressCallback;
@@ -124,43 +195,139 @@ public:
 		return Processing.load();
 	}
 
-	/* Returns File Path */
-	std::wstring GetFile(ModInfo* callerPointer, const Status& statusCallback, const Progress& progressCallback)
+	/* only the first caller gets true, that caller is responsible for downloading and extracting the file */
+	bool TryClaim()
+	{
+		return !Claimed.exchange(true);
+	}
+
+	/* extracted, or failed and never will be */
+	bool CheckIfReady()
+	{
+		return Extracted.load() || Failed.load();
+	}
+
+	bool CheckIfExtracted()
+	{
+		return Extracted.load();
+	}
+
+	bool CheckIfFailed()
+	{
+		return Failed.load();
+	}
+
+	bool CheckIfDirectInstall()
+	{
+		return DirectInstall.load();
+	}
+
+	/// <summary>
+	/// limits extraction to the paths users of the file actually copy out, only matching archive items get extracted
+	/// </summary>
+	/// <param name="insidePath">- path inside the archive</param>
+	/// <param name="recursive">- if everything under the path is needed, or only the files directly inside it</param>
+	void AddExtractPath(const std::wstring& insidePath, const bool& recursive);
+
+	/* Download stage, does nothing if the file was already downloaded by another user */
+	bool Download(ModInfo* callerPointer, const Status& statusCallback, const Progress& progressCallback)
 	{
+		if (Failed.load())
+		{
+			return false;
+		}
+
+		if (Downloaded.load() || Extracted.load())
+		{
+			return true;
+		}
+
 		Processing = true;
+		UpdateCallbacks(callerPointer, statusCallback, progressCallback);
 
-		/* Update Callbacks */
-		CallerPointer = callerPointer;
-		StatusCallback = statusCallback;
-		ProgressCallback = progressCallback;
+		bool downloaded = DownloadFile();
+		FinishDownloadEstimate();
+
+		if (!downloaded)
+		{
+			Failed = true;
+			return false;
+		}
+
+		Downloaded = true;
+		return true;
+	}
+
+	/* Extract stage, needs the file to be downloaded first */
+	bool Extract(ModInfo* callerPointer, const Status& statusCallback, const Progress& progressCallback)
+	{
+		if (Failed.load())
+		{
+			return false;
+		}
 
-		if (!(Extracted.load()))
+		if (Extracted.load())
 		{
-			if (!DownloadFile())
-			{
-				return L"";
-			}
+			return true;
+		}
 
-			if (!ExtractFile())
-			{
-				return L"";
-			}
+		UpdateCallbacks(callerPointer, statusCallback, progressCallback);
 
-			Extracted = true;
+		if (!ExtractFile())
+		{
+			Failed = true;
+			return false;
 		}
 
+		Extracted = true;
 		Processing = false;
+		return true;
+	}
+
+	/* Returns File Path */
+	std::wstring GetFile(ModInfo* callerPointer, const Status& statusCallback, const Progress& progressCallback)
+	{
+		if (!Download(callerPointer, statusCallback, progressCallback))
+		{
+			return L"";
+		}
+
+		if (!Extract(callerPointer, statusCallback, progressCallback))
+		{
+			return L"";
+		}
 
 		return GetExtractPath();
 	}
 
+	/// <summary>
+	/// writes the archive items matching <paramref name="targets"/> straight into their destinations, skipping the extract directory.
+	/// Only for files which went through Extract as a direct install, safe to call from many users at once
+	/// </summary>
+	/// <param name="callerPointer">- mod receiving the progress</param>
+	/// <param name="progressCallback">- progress callback on the mod</param>
+	/// <param name="targets">- inner paths and where they go</param>
+	/// <param name="owner">- mod the written files get recorded under in the InstallManifest</param>
+	/// <returns>true if every item was written</returns>
+	bool InstallDirect(ModInfo* callerPointer, const Progress& progressCallback, const std::vector<ExtractTarget>& targets, const std::wstring& owner);
+
+	Version GetVersion()
+	{
+		return DownloadedVersion;
+	}
+
+	/// <summary>
+	/// asks the server if the file is still <paramref name="version"/>, without downloading it
+	/// </summary>
+	/// <param name="version">- version from an earlier download</param>
+	/// <returns>true only if the server said it hasn't changed</returns>
+	bool CheckIfUnchanged(const Version& version);
+
 	/* Finished using file */
 	inline void Finished()
 	{
-		UsageCount--;
-
-		/* More file objects are using */
-		if (UsageCount > 0)
+		/* More file objects are using. Decremented and checked in 1 step, users on different threads can finish at the same time */
+		if (UsageCount.fetch_sub(1) != 1)
 		{
 			return;
 		}
@@ -175,6 +342,7 @@ public:
 			NosLib::Logging::CreateLog<wchar_t>(std::format(L"error: \"{}\" When trying to remove extract directory", NosLib::String::ToWstring(ec.message())), NosLib::Logging::Severity::Error);
 		}
 
+		FreeArchiveBuffer();
 		fileHastTable.Remove(GetKey());
 		delete this;
 	}
@@ -184,11 +352,29 @@ public:
 		return Link.Full();
 	}
 protected:
+	void UpdateCallbacks(ModInfo* callerPointer, const Status& statusCallback, const Progress& progressCallback)
+	{
+		CallerPointer = callerPointer;
+		StatusCallback = statusCallback;
+		ProgressCallback = progressCallback;
+	}
+
 	std::wstring GetDownloadPath()
 	{
 		return DownloadDirectory + FileName.GetFullFileName();
 	}
 
+	/* download in progress, gets renamed to the download path once complete */
+	std::wstring GetPartPath()
+	{
+		return DownloadDirectory + FileName.GetFileName() + L".part";
+	}
+
+	std::wstring GetStatePath()
+	{
+		return GetPartPath() + L".state";
+	}
+
 	std::wstring GetExtractPath()
 	{
 		return ExtractDirectory + FileName.GetFileName();
@@ -196,10 +382,26 @@ protected:
 
 	std::wstring GetFileExtensionFromHeader(const std::string& type);
 	HostType DetermineHostType(const std::wstring& hostName);
+	bool OpenDownloadClient(ConnectionPool::Lease* downloadClient, std::string* downloadHost, std::wstring* downloadLink);
 	bool DownloadFile();
 	bool ModDBDownload(httplib::Client* downloadClient, const std::wstring& pathOffsets);
 	bool GithubDownload(httplib::Client* downloadClient, const std::wstring& pathOffsets);
-	bool GetAndSaveFile(httplib::Client* client, const std::wstring& urlFilePath, const std::wstring& pathOffsets);
-
+	bool GetAndSaveFile(httplib::Client* client, const std::string& hostUrl, const std::wstring& urlFilePath);
+	bool ProbeRemoteFile(httplib::Client* client, const std::string& hostUrl, const std::string& urlFilePath, RemoteFileInfo* remoteInfo, const ArchiveCache::Entry* cachedEntry);
+	bool SingleStreamDownload(httplib::Client* client, const std::string& urlFilePath, RemoteFileInfo* remoteInfo);
+	bool RangedDownload(const RemoteFileInfo& remoteInfo);
+	bool MemoryDownload(const RemoteFileInfo& remoteInfo);
+	bool ReserveMemory(const uint64_t& size);
+	void FreeArchiveBuffer();
+	bool FinalizePartFile();
+	bool RestoreFromCache(const ArchiveCache::Entry& entry);
+
+	void CountDownloadSize(const uint64_t& size);
+	void CountDownloaded(const std::string& hostUrl, const uint64_t& bytes);
+	void FinishDownloadEstimate();
+	void StoreInCache(const RemoteFileInfo& remoteInfo);
+
+	std::unique_ptr<bit7z::BitArchiveReader> OpenArchive();
+	bool WantsItem(const std::wstring& itemPath);
 	bool ExtractFile();
 };
\ No newline at end of file
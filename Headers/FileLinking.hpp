@@ -0,0 +1,47 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <cstdint>
+
+/// <summary>
+/// puts files from the extract directory into their mod folders without copying the bytes when the filesystem allows it
+/// </summary>
+namespace FileLinking
+{
+	/* files from this size on get copied by the system (hashed by a separate read), below it the single pass copy+hash is quicker */
+	inline constexpr uint64_t NativeCopyThreshold = 4ull * 1024 * 1024;
+
+	/// <summary>
+	/// creates a reflink (block clone) of <paramref name="from"/> at <paramref name="to"/>, both files share the data until one gets written to
+	/// </summary>
+	/// <param name="from">- source file</param>
+	/// <param name="to">- target file, gets replaced</param>
+	/// <returns>true if the filesystem cloned the file, false if it can't (nothing is left behind at <paramref name="to"/>)</returns>
+	bool CloneFile(const std::filesystem::path& from, const std::filesystem::path& to);
+
+	/// <summary>
+	/// copies a file without the bytes going through the program (CopyFileEx on windows, copy_file_range/sendfile on linux)
+	/// </summary>
+	/// <param name="from">- source file</param>
+	/// <param name="to">- target file, gets replaced</param>
+	/// <returns>true if successful, false if the caller has to copy it itself</returns>
+	bool CopyFileNative(const std::filesystem::path& from, const std::filesystem::path& to);
+
+	/// <summary>
+	/// copies a file in chunks, hashing the bytes as they go through
+	/// </summary>
+	/// <param name="from">- source file</param>
+	/// <param name="to">- target file, gets replaced</param>
+	/// <param name="hexDigest">- gets set to the XXH64 of the file</param>
+	/// <returns>true if successful</returns>
+	bool CopyFileHashed(const std::filesystem::path& from, const std::filesystem::path& to, std::string* hexDigest);
+
+	/// <summary>
+	/// installs a single file, tries a hardlink (if enabled), then a reflink, then copies. The file gets recorded in the InstallManifest
+	/// </summary>
+	/// <param name="from">- source file</param>
+	/// <param name="to">- target file, gets replaced</param>
+	/// <param name="owner">- mod installing the file</param>
+	void InstallFile(const std::filesystem::path& from, const std::filesystem::path& to, const std::wstring& owner);
+}
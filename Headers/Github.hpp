@@ -2,6 +2,10 @@
 
 #include <NosLib/HttpClient.hpp>
 
+#include "ConnectionPool.hpp"
+
+#include <string>
+
 class Github
 {
 protected:
@@ -20,27 +24,20 @@ protected:
 		#endif // 0
 	}
 public:
-	inline static NosLib::HttpClient::ptr CreateDownloadClient()
+	inline static const std::string HostUrl = "https://github.com";
+	inline static const std::string ObjectsHostUrl = "https://objects.githubusercontent.com";
+
+	inline static ConnectionPool::Lease CreateDownloadClient()
 	{
 		Initialize();
 
-		NosLib::HttpClient::ptr githubClient;
-		githubClient = NosLib::HttpClient::MakeClient("https://github.com");
-		githubClient->set_follow_location(true);
-		githubClient->set_keep_alive(true);
-
-		return githubClient;
+		return ConnectionPool::Acquire(HostUrl);
 	}
 
-	inline static NosLib::HttpClient::ptr CreateDownloadObjectsClient()
+	inline static ConnectionPool::Lease CreateDownloadObjectsClient()
 	{
 		Initialize();
 
-		NosLib::HttpClient::ptr githubObjectsClient;
-		githubObjectsClient = NosLib::HttpClient::MakeClient("https://objects.githubusercontent.com");
-		githubObjectsClient->set_follow_location(true);
-		githubObjectsClient->set_keep_alive(true);
-
-		return githubObjectsClient;
+		return ConnectionPool::Acquire(ObjectsHostUrl);
 	}
 };
\ No newline at end of file
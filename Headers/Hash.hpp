@@ -0,0 +1,258 @@
+#pragma once
+
+#include <string>
+#include <format>
+#include <fstream>
+#include <streambuf>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+/// <summary>
+/// Streaming XXH64, fast non cryptographic hash used to tell file contents apart (cache keys, install verification)
+/// </summary>
+class XXH64Hasher
+{
+protected:
+	inline static constexpr uint64_t Prime1 = 11400714785074694791ull;
+	inline static constexpr uint64_t Prime2 = 14029467366897019727ull;
+	inline static constexpr uint64_t Prime3 = 1609587929392839161ull;
+	inline static constexpr uint64_t Prime4 = 9650029242287828579ull;
+	inline static constexpr uint64_t Prime5 = 2870177450012600261ull;
+
+	uint64_t Seed;
+	uint64_t Accumulators[4];
+	uint64_t TotalLength = 0;
+
+	unsigned char Buffer[32]; /* input which didn't fill a whole 32 byte stripe yet */
+	size_t BufferedLength = 0;
+
+	static uint64_t RotateLeft(const uint64_t& value, const int& bits)
+	{
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	static uint64_t Read64(const unsigned char* data)
+	{
+		uint64_t value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	static uint32_t Read32(const unsigned char* data)
+	{
+		uint32_t value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	static uint64_t Round(uint64_t accumulator, const uint64_t& input)
+	{
+		accumulator += input * Prime2;
+		accumulator = RotateLeft(accumulator, 31);
+		return accumulator * Prime1;
+	}
+
+	static uint64_t MergeRound(uint64_t accumulator, const uint64_t& value)
+	{
+		accumulator ^= Round(0, value);
+		return accumulator * Prime1 + Prime4;
+	}
+
+	void ConsumeStripe(const unsigned char* stripe)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			Accumulators[i] = Round(Accumulators[i], Read64(stripe + (i * 8)));
+		}
+	}
+
+public:
+	XXH64Hasher(const uint64_t& seed = 0)
+	{
+		Seed = seed;
+		Accumulators[0] = seed + Prime1 + Prime2;
+		Accumulators[1] = seed + Prime2;
+		Accumulators[2] = seed;
+		Accumulators[3] = seed - Prime1;
+	}
+
+	void Update(const void* data, size_t length)
+	{
+		const unsigned char* input = static_cast<const unsigned char*>(data);
+		TotalLength += length;
+
+		/* top up the leftover stripe first */
+		if (BufferedLength > 0)
+		{
+			size_t fill = 32 - BufferedLength;
+			fill = (fill > length ? length : fill);
+
+			std::memcpy(Buffer + BufferedLength, input, fill);
+			BufferedLength += fill;
+			input += fill;
+			length -= fill;
+
+			if (BufferedLength < 32)
+			{
+				return;
+			}
+
+			ConsumeStripe(Buffer);
+			BufferedLength = 0;
+		}
+
+		for (; length >= 32; input += 32, length -= 32)
+		{
+			ConsumeStripe(input);
+		}
+
+		std::memcpy(Buffer, input, length);
+		BufferedLength = length;
+	}
+
+	uint64_t Digest() const
+	{
+		uint64_t hash;
+
+		if (TotalLength >= 32)
+		{
+			hash = RotateLeft(Accumulators[0], 1) + RotateLeft(Accumulators[1], 7) + RotateLeft(Accumulators[2], 12) + RotateLeft(Accumulators[3], 18);
+			for (int i = 0; i < 4; i++)
+			{
+				hash = MergeRound(hash, Accumulators[i]);
+			}
+		}
+		else
+		{
+			hash = Seed + Prime5;
+		}
+
+		hash += TotalLength;
+
+		const unsigned char* tail = Buffer;
+		size_t tailLength = BufferedLength;
+
+		for (; tailLength >= 8; tail += 8, tailLength -= 8)
+		{
+			hash ^= Round(0, Read64(tail));
+			hash = RotateLeft(hash, 27) * Prime1 + Prime4;
+		}
+
+		if (tailLength >= 4)
+		{
+			hash ^= static_cast<uint64_t>(Read32(tail)) * Prime1;
+			hash = RotateLeft(hash, 23) * Prime2 + Prime3;
+			tail += 4;
+			tailLength -= 4;
+		}
+
+		for (; tailLength > 0; tail++, tailLength--)
+		{
+			hash ^= (*tail) * Prime5;
+			hash = RotateLeft(hash, 11) * Prime1;
+		}
+
+		/* avalanche */
+		hash ^= hash >> 33;
+		hash *= Prime2;
+		hash ^= hash >> 29;
+		hash *= Prime3;
+		hash ^= hash >> 32;
+
+		return hash;
+	}
+
+	std::string HexDigest() const
+	{
+		return std::format("{:016x}", Digest());
+	}
+
+	/// <summary>
+	/// hashes a whole file
+	/// </summary>
+	/// <param name="filePath">- file to hash</param>
+	/// <param name="hexDigest">- gets set to the hash as 16 hex characters</param>
+	/// <returns>false if the file couldn't be read</returns>
+	static bool HashFile(const std::wstring& filePath, std::string* hexDigest)
+	{
+		std::ifstream file(filePath, std::ios::binary);
+		if (!file.is_open())
+		{
+			return false;
+		}
+
+		XXH64Hasher hasher;
+		std::vector<char> chunk(1024 * 1024);
+
+		while (file)
+		{
+			file.read(chunk.data(), chunk.size());
+			hasher.Update(chunk.data(), static_cast<size_t>(file.gcount()));
+		}
+
+		if (file.bad())
+		{
+			return false;
+		}
+
+		*hexDigest = hasher.HexDigest();
+		return true;
+	}
+};
+
+/// <summary>
+/// Output stream buffer which hashes everything written through it before passing it on, so files get hashed while they are written
+/// </summary>
+class XXH64StreamBuffer : public std::streambuf
+{
+protected:
+	std::streambuf* Target;
+	XXH64Hasher Hasher;
+	uint64_t WrittenBytes = 0;
+
+	int_type overflow(int_type character) override
+	{
+		if (traits_type::eq_int_type(character, traits_type::eof()))
+		{
+			return traits_type::not_eof(character);
+		}
+
+		char data = traits_type::to_char_type(character);
+		if (traits_type::eq_int_type(Target->sputc(data), traits_type::eof()))
+		{
+			return traits_type::eof();
+		}
+
+		Hasher.Update(&data, 1);
+		WrittenBytes++;
+		return character;
+	}
+
+	std::streamsize xsputn(const char* data, std::streamsize count) override
+	{
+		std::streamsize written = Target->sputn(data, count);
+
+		Hasher.Update(data, static_cast<size_t>(written));
+		WrittenBytes += written;
+		return written;
+	}
+
+	int sync() override
+	{
+		return Target->pubsync();
+	}
+
+public:
+	XXH64StreamBuffer(std::streambuf* target) : Target(target) {}
+
+	std::string HexDigest() const
+	{
+		return Hasher.HexDigest();
+	}
+
+	uint64_t GetWrittenBytes() const
+	{
+		return WrittenBytes;
+	}
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+/// <summary>
+/// Runs the whole install from the command line, without any window. For unattended installs and for timing installs without the cost of the GUI
+/// </summary>
+namespace HeadlessInstall
+{
+	/// <returns>true if the arguments ask for a headless install ("--headless")</returns>
+	bool IsRequested(int argc, char* argv[]);
+
+	/// <summary>
+	/// reads the paths and options from the arguments and runs the install, progress goes to stdout
+	/// </summary>
+	/// <returns>exit code, 0 if the install ran. 2 for bad arguments</returns>
+	int Run(int argc, char* argv[]);
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <NosLib/HttpClient.hpp>
+
+#include <string>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+/// <summary>
+/// Limits parallel requests per host with AIMD, the limit slowly goes up while the host answers fine and gets halved when it
+/// pushes back (503/429 or timeouts). So requests run as parallel as the host tolerates instead of a fixed amount which can get the user blocked
+/// </summary>
+class HostGovernor
+{
+public:
+	enum class Outcome
+	{
+		Healthy,
+		Throttled,	/* 503, 429 or no response, request should be retried later */
+		Failed,		/* answered, but with an error that retrying won't fix. Doesn't affect the limit */
+	};
+
+protected:
+	struct HostState
+	{
+		std::mutex StateMutex;
+		std::condition_variable SlotFreed;
+		double Limit = InitialLimit;
+		int Active = 0;
+		std::chrono::steady_clock::time_point LastDecrease;
+	};
+
+public:
+	/// <summary>
+	/// a slot for 1 request to a host, freed once destroyed
+	/// </summary>
+	class Permit
+	{
+	protected:
+		HostState* State = nullptr;
+
+	public:
+		Permit(HostState* state)
+		{
+			State = state;
+		}
+
+		Permit(const Permit&) = delete;
+		Permit& operator=(const Permit&) = delete;
+
+		~Permit();
+
+		/// <summary>
+		/// feeds how the request went into the limit of the host
+		/// </summary>
+		void Report(const Outcome& outcome);
+	};
+
+	inline static constexpr double InitialLimit = 4;
+	inline static constexpr double MaxLimit = 16;
+	inline static constexpr int RetryAttempts = 5;
+
+protected:
+	inline static constexpr std::chrono::milliseconds DecreaseCooldown = std::chrono::milliseconds(2000); /* requests failing together only halve the limit once */
+	inline static constexpr std::chrono::milliseconds RetryBaseDelay = std::chrono::milliseconds(1000);
+	inline static constexpr std::chrono::milliseconds RetryMaxDelay = std::chrono::milliseconds(30000);
+
+	inline static std::mutex HostsMutex;
+	inline static std::unordered_map<std::string, std::unique_ptr<HostState>> Hosts; /* by host url */
+
+public:
+	/// <summary>
+	/// waits until the host has a free slot
+	/// </summary>
+	/// <param name="hostUrl">- scheme + host, example "https://www.moddb.com"</param>
+	static std::unique_ptr<Permit> Acquire(const std::string& hostUrl);
+
+	/// <returns>how a response counts for the limit</returns>
+	static Outcome Classify(const httplib::Result& result);
+
+	/// <param name="status">- http status of the response, 0 if there was none</param>
+	/// <returns>how a response counts for the limit</returns>
+	static Outcome Classify(const int& status);
+
+	/// <summary>
+	/// waits before retry number <paramref name="attempt"/> (starting at 0), exponential with random jitter so throttled requests don't all come back at once
+	/// </summary>
+	static void WaitBeforeRetry(const int& attempt);
+
+	/// <returns>current limit of the host, InitialLimit if the host wasn't used yet</returns>
+	static int GetLimit(const std::string& hostUrl);
+
+protected:
+	static HostState* GetHostState(const std::string& hostUrl);
+};
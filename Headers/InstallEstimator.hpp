@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+/// <summary>
+/// Estimates how much of the install is done and how long the rest takes, by bytes instead of mod count (a small script mod and a huge texture pack aren't equal).
+/// Work is what is left to download and extract, files without a known size yet count as the average of the known ones.
+/// Rates are exponentially weighted moving averages over every worker together
+/// </summary>
+class InstallEstimator
+{
+public:
+	struct Estimate
+	{
+		int Percentage = 0;
+		double SecondsLeft = -1;			/* -1 while there isn't enough to go off */
+		double DownloadBytesPerSecond = 0;
+		double ExtractBytesPerSecond = 0;
+	};
+
+protected:
+	/* download or extraction, by bytes */
+	struct Stage
+	{
+		std::atomic<uint64_t> KnownTotal;	/* sizes of the files whose size is known */
+		std::atomic<uint64_t> Done;
+		std::atomic<int> SizedFiles;
+
+		/* sampling side */
+		uint64_t LastDone;
+		double Rate;
+
+		Stage() : KnownTotal(0), Done(0), SizedFiles(0), LastDone(0), Rate(0) {}
+
+		uint64_t GetRemaining(const int& fileCount) const;
+	};
+
+	inline static constexpr double RateSmoothing = 0.2;						/* weight of the newest sample in the moving average */
+	inline static constexpr uint64_t DefaultFileSize = 50ull * 1024 * 1024;	/* guess for unknown sizes, until the first size is known */
+
+	inline static Stage Download;
+	inline static Stage Extract;
+	inline static std::atomic<int> FileCount = 0;
+	inline static std::atomic<int> ModCount = 0;
+	inline static std::atomic<int> CompletedMods = 0;
+
+	inline static std::mutex SampleMutex;
+	inline static std::chrono::steady_clock::time_point LastSample;
+
+public:
+	/// <summary>
+	/// starts a new estimate
+	/// </summary>
+	/// <param name="fileCount">- amount of files which will be downloaded and extracted</param>
+	/// <param name="modCount">- amount of mods which will be installed</param>
+	static void Start(const int& fileCount, const int& modCount);
+
+	/* worker side, all of these are a few atomic adds */
+
+	/// <summary>
+	/// a file found out its download size, call once per file
+	/// </summary>
+	static void AddDownloadSize(const uint64_t& bytes);
+	static void AddDownloaded(const uint64_t& bytes);
+
+	/// <summary>
+	/// a file found out how much it will extract, call once per file
+	/// </summary>
+	static void AddExtractSize(const uint64_t& bytes);
+	static void AddExtracted(const uint64_t& bytes);
+
+	static void ModCompleted();
+
+	/* display side */
+
+	/// <summary>
+	/// updates the rates from what got done since the last call and estimates the rest. Meant to be called about once a second
+	/// </summary>
+	static Estimate Sample();
+
+protected:
+	static double UpdateRate(Stage* stage, const double& seconds);
+};
@@ -6,9 +6,10 @@
 #include <NosLib/FileManagement.hpp>
 #include "InstallOptions.hpp"
 
-#include "../CustomWidgets/MultiThreadProgress.hpp"
+#include "ProgressSink.hpp"
 
 #include <fstream>
+#include <format>
 #include <chrono>
 #include <mutex>
 
@@ -20,30 +21,37 @@ private:
 	inline static InstallManager* Instance = nullptr;
 
 	inline static std::mutex InstanceMutex;
-	inline static std::mutex TotalProgressMutex;
 
-	ProgressStatus* RegisteredStatusProgress;
+	std::shared_ptr<ProgressSlot> StatusSlot;
+	int FailedModCount = 0; /* mods with errors during the last install */
 
 signals:
 	void FinishInstallerInitializing();
 	void FinishInstalling(const std::wstring&);
 
-	void TotalUpdateProgress(const int&);
-	void ModUpdateProgress(const int&);
-	void ModUpdateStatus(const std::wstring&);
-
 public:
+	/* progress of mods processed outside of the pipeline, goes into the installers own progress bar */
 	void UpdateModProgress(const int& value)
 	{
-		emit ModUpdateProgress(value);
+		StatusSlot->SetPercentage(value);
+	}
+
+	void UpdateModProgress(const uint64_t& done, const uint64_t& total)
+	{
+		StatusSlot->SetProgress(done, total);
 	}
 
 	void UpdateModStatus(const std::wstring& value)
 	{
-		emit ModUpdateStatus(value);
+		StatusSlot->SetStatus(value);
 	}
 
-	MultiThreadProgress* ProgressContainer = nullptr;
+	ProgressSink* ProgressContainer = nullptr; /* the installer window's progress bars, or the console when headless */
+
+	int GetFailedModCount() const
+	{
+		return FailedModCount;
+	}
 
 	inline InstallManager(QObject* parent = nullptr) : QObject(parent)
 	{}
@@ -60,16 +68,11 @@ public:
 		return Instance;
 	}
 
-	void UpdateTotalProgress(const int& value)
-	{
-		std::lock_guard<std::mutex> lk(TotalProgressMutex);
-		emit TotalUpdateProgress(value);
-	}
-
 public slots:
 	inline void StartInstall()
 	{
 		auto start = std::chrono::system_clock::now();
+		FailedModCount = 0;
 
 		InitializeInstaller();
 		emit FinishInstallerInitializing();
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <filesystem>
+#include <mutex>
+#include <cstdint>
+
+/// <summary>
+/// Record of every file the installer wrote: owning mod, path, size, modification time and XXH64 of the contents.
+/// Kept in memory while installing (files get added from many threads) and saved next to the install once it's done
+/// </summary>
+class InstallManifest
+{
+public:
+	struct Record
+	{
+		std::wstring Owner;		/* owner key (ModInfo::GetOwnerKey) of the mod which wrote the file last */
+		std::wstring Path;		/* relative to the install path, absolute for files outside of it (anomaly patches) */
+		uint64_t Size = 0;
+		int64_t ModifiedTime = 0;	/* filesystem clock ticks */
+		std::string Hash;		/* XXH64 as hex */
+	};
+
+	inline static const std::wstring ManifestName = L"install_manifest.txt";
+
+protected:
+	inline static std::mutex ManifestMutex;
+	inline static std::wstring InstallPath;
+	inline static std::unordered_map<std::wstring, Record> Records; /* by lowercase path, windows paths aren't case sensitive */
+
+public:
+	/// <summary>
+	/// sets the install the manifest belongs to, and loads what earlier installs recorded
+	/// </summary>
+	/// <param name="installPath">- GAMMA install directory</param>
+	static void Load(const std::wstring& installPath);
+
+	/// <summary>
+	/// records a file that was just written
+	/// </summary>
+	/// <param name="owner">- mod which wrote it</param>
+	/// <param name="filePath">- the written file</param>
+	/// <param name="hash">- XXH64 of what was written</param>
+	static void AddFile(const std::wstring& owner, const std::filesystem::path& filePath, const std::string& hash);
+
+	/// <summary>
+	/// forgets every file inside a directory (deleted mod folder)
+	/// </summary>
+	static void RemoveDirectory(const std::filesystem::path& directory);
+
+	/// <summary>
+	/// moves every file inside a directory to another one (renamed mod folder), the files keep their owners
+	/// </summary>
+	/// <param name="from">- directory path, ending with a separator</param>
+	/// <param name="to">- directory path, ending with a separator</param>
+	static void MoveDirectory(const std::filesystem::path& from, const std::filesystem::path& to);
+
+	static std::vector<Record> GetRecords();
+
+	/// <summary>
+	/// turns a manifest path back into a full path
+	/// </summary>
+	static std::filesystem::path GetFullPath(const Record& record);
+
+	static bool Save();
+
+protected:
+	static std::wstring ToManifestPath(const std::filesystem::path& filePath);
+	static std::wstring AsDirectory(const std::wstring& manifestPath);
+	static std::wstring ToKey(const std::wstring& manifestPath);
+	static std::wstring GetManifestPath();
+};
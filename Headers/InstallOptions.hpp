@@ -1,6 +1,8 @@
 #pragma once
 
 #include <string>
+#include <thread>
+#include <cstdint>
 
 namespace InstallInfo
 {
@@ -15,4 +17,26 @@ namespace InstallOptions
 	inline std::wstring GammaInstallPath;
 
 	inline bool AddOverwriteFiles = true;
+
+	/* Only installs the mods which changed since the last install into GammaInstallPath, see ModpackUpdate */
+	inline bool UpdateExistingInstall = false;
+
+	/* Checks the install in GammaInstallPath against its manifest and only reinstalls mods with missing or damaged files, see InstallRepair */
+	inline bool VerifyExistingInstall = false;
+
+	/* Installs mod files as hardlinks to the extracted files instead of copies (costs no space or time, but the files stay linked). Reflinks get used whenever the filesystem supports them either way */
+	inline bool UseHardlinks = false;
+
+	/* Keeps downloaded archives for later installs, see ArchiveCache. Empty directory means the default one */
+	inline bool UseArchiveCache = false;
+	inline std::wstring ArchiveCacheDirectory;
+	inline uint64_t ArchiveCacheSizeLimit = 64ull * 1024 * 1024 * 1024;
+
+	/* Picks the fastest ModDB mirror for each mod instead of the one ModDB suggests, see MirrorProber. Resolving every mirror can get the user rate limited by ModDB */
+	inline bool ProbeMirrors = false;
+
+	/* Worker counts for each install stage, downloading waits on the network, extracting on the cpu and installing on the disk */
+	inline int DownloadThreads = 12;
+	inline int ExtractThreads = (std::thread::hardware_concurrency() == 0 ? 4 : static_cast<int>(std::thread::hardware_concurrency()));
+	inline int InstallThreads = 3;
 }
\ No newline at end of file
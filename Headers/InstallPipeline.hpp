@@ -0,0 +1,54 @@
+#pragma once
+
+#include <NosLib/DynamicArray.hpp>
+
+#include "BoundedQueue.hpp"
+
+#include <unordered_map>
+#include <vector>
+#include <atomic>
+
+class ModInfo;
+class File;
+
+/// <summary>
+/// Installs mods in 3 stages (download -> extract -> install) joined by bounded queues, each stage has its own pool of workers.
+/// Every file starts downloading straight away, only installing waits on the mods' dependencies
+/// </summary>
+class InstallPipeline
+{
+protected:
+	NosLib::DynamicArray<ModInfo*>& Mods;
+
+	/* Download and extract queues carry 1 mod per file (the first mod using it), the install queue carries every mod */
+	BoundedQueue<ModInfo*> DownloadQueue;
+	BoundedQueue<ModInfo*> ExtractQueue;
+	BoundedQueue<ModInfo*> InstallQueue; /* fits every mod, releasing a mod never blocks */
+
+	/* every mod using a file, files are shared between mods with the same link. Filled before the workers start, read only after */
+	std::unordered_map<File*, std::vector<ModInfo*>> FileUsers;
+
+	std::atomic<int> ActiveDownloaders = 0;
+	std::atomic<int> ActiveExtractors = 0;
+
+	int ModCount = 0;
+	std::atomic<int> CompleteCount = 0;
+
+public:
+	/// <param name="mods">- mods to install, dependencies between them decide the install order</param>
+	InstallPipeline(NosLib::DynamicArray<ModInfo*>& mods);
+
+	/// <summary>
+	/// installs all the mods, returns once everything is installed
+	/// </summary>
+	void Run();
+
+protected:
+	void Submit(ModInfo* mod);
+	void FileReady(File* file);
+	void ReleaseMod(ModInfo* mod);
+
+	void DownloadWorker();
+	void ExtractWorker();
+	void InstallWorker();
+};
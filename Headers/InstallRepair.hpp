@@ -0,0 +1,35 @@
+#pragma once
+
+#include <NosLib/DynamicArray.hpp>
+
+#include <string>
+#include <unordered_set>
+
+class ModInfo;
+
+/// <summary>
+/// Checks an existing install against its InstallManifest and only reinstalls the mods which own missing or damaged files
+/// </summary>
+namespace InstallRepair
+{
+	/// <summary>
+	/// checks every file in the manifest. Everything gets stat'ed first, only files with the right size but a different modification time get hashed (spread over all cores)
+	/// </summary>
+	/// <returns>owner keys (ModInfo::GetOwnerKey) of the mods which own a missing or damaged file</returns>
+	std::unordered_set<std::wstring> FindDamagedOwners();
+
+	/// <summary>
+	/// reinstalling a mod overwrites what the mods installed after it (its dependents) put over its files, so those have to be installed again as well
+	/// </summary>
+	/// <param name="mods">- every mod of the install, with their dependencies set up</param>
+	/// <param name="damagedOwners">- owner keys of the mods getting installed again (FindDamagedOwners, or changed files when updating)</param>
+	/// <returns>owner keys of those mods and every mod depending on them</returns>
+	std::unordered_set<std::wstring> AddDependents(NosLib::DynamicArray<ModInfo*>& mods, const std::unordered_set<std::wstring>& damagedOwners);
+
+	/// <summary>
+	/// marks every mod which was installed before and isn't damaged as up to date, the pipeline skips those
+	/// </summary>
+	/// <param name="mods">- mods to check</param>
+	/// <param name="damagedOwners">- result of AddDependents</param>
+	void Apply(NosLib::DynamicArray<ModInfo*>& mods, const std::unordered_set<std::wstring>& damagedOwners);
+}
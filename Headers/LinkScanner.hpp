@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+/// <summary>
+/// Picks links ("a" tags with a href) out of html while it's being downloaded, without building a DOM.
+/// Can stop at the first match, so the rest of the page doesn't need to be downloaded at all
+/// </summary>
+class LinkScanner
+{
+protected:
+	inline static constexpr size_t MaxPendingSize = 64 * 1024; /* a tag which doesn't close within this is broken html, gets dropped */
+
+	std::string AnchorId;	/* only "a" tags with this id, empty means any */
+	bool FirstOnly;
+
+	std::string Pending;	/* incomplete tag carried over to the next chunk */
+	std::string RawTextEnd;	/* inside script/style/comment, everything is skipped until this */
+	bool Done = false;
+
+	std::vector<std::string> Links;
+
+public:
+	/// <param name="anchorId">- only take "a" tags with this id, empty takes any "a" tag</param>
+	/// <param name="firstOnly">- stop at the first matching link</param>
+	LinkScanner(const std::string& anchorId = "", const bool& firstOnly = true)
+	{
+		AnchorId = anchorId;
+		FirstOnly = firstOnly;
+	}
+
+	/// <summary>
+	/// scans the next part of the page
+	/// </summary>
+	/// <returns>false once the scanner has everything it needs, the rest of the page can be dropped</returns>
+	bool Feed(const char* data, const size_t& length);
+
+	/// <returns>href of every matching "a" tag, in page order</returns>
+	const std::vector<std::string>& GetLinks() const
+	{
+		return Links;
+	}
+
+protected:
+	/// <summary>
+	/// handles a whole tag, <paramref name="tag"/> is everything between "&lt;" and "&gt;"
+	/// </summary>
+	void ProcessTag(const std::string& tag);
+};
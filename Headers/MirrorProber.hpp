@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <future>
+#include <mutex>
+#include <cstdint>
+
+/// <summary>
+/// Rates download mirrors by how long the first response takes (connect + TLS + server) and how fast a short ranged download runs.
+/// Each host gets measured once, scores are shared between every mod of the session and saved for the next runs
+/// </summary>
+class MirrorProber
+{
+public:
+	struct Score
+	{
+		double LatencyMs = 0;		/* request start until the response headers arrived */
+		double BytesPerSecond = 0;	/* throughput of the sample download */
+		bool Reachable = false;
+		uint64_t MeasuredAt = 0;	/* seconds since epoch */
+
+		/// <returns>seconds a typical archive would take from this host, lower is better</returns>
+		double GetEstimatedSeconds() const;
+	};
+
+	/* a mirror to rate, SamplePath is a file on it which supports ranged requests (the file about to be downloaded) */
+	struct Candidate
+	{
+		std::string HostUrl;	/* scheme + host, example "https://mirror.example.com" or "http://127.0.0.1:8080" */
+		std::string SamplePath;
+	};
+
+protected:
+	inline static constexpr uint64_t SampleBytes = 512ull * 1024;
+	inline static constexpr uint64_t SampleTimeLimitMs = 3000;			/* slow mirrors get judged on whatever arrived by then */
+	inline static constexpr uint64_t ScoreLifetime = 24ull * 60 * 60;	/* saved scores older than this get measured again */
+	inline static constexpr double TypicalArchiveSize = 64.0 * 1024 * 1024;
+
+	inline static std::mutex ProberMutex;
+	inline static std::wstring ScoresPath;
+	inline static std::unordered_map<std::string, Score> Scores;						/* by host url */
+	inline static std::unordered_map<std::string, std::shared_future<Score>> InFlight;	/* hosts being measured right now, by host url */
+
+public:
+	/// <summary>
+	/// loads the scores saved by earlier runs
+	/// </summary>
+	/// <param name="scoresPath">- file the scores get saved in, empty uses the default path</param>
+	static void Initialize(const std::wstring& scoresPath);
+
+	/// <returns>per user file, "%LOCALAPPDATA%\NorzkasGammaInstaller\mirror_scores.txt" on windows</returns>
+	static std::wstring GetDefaultPath();
+
+	/// <summary>
+	/// score of the host, measured only if there is no recent one. Concurrent callers for the same host wait on the same measurement
+	/// </summary>
+	static Score GetScore(const Candidate& candidate);
+
+	/// <summary>
+	/// measures the host right now, without looking at or updating the saved scores
+	/// </summary>
+	static Score Measure(const Candidate& candidate);
+
+	/// <summary>
+	/// rates every candidate (in parallel, only hosts without a recent score get measured)
+	/// </summary>
+	/// <returns>index of the candidate with the lowest estimated download time, -1 if none of them were reachable</returns>
+	static int PickFastest(const std::vector<Candidate>& candidates);
+
+protected:
+	static void LoadScores();
+	static bool SaveScores();
+};
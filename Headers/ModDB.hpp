@@ -2,22 +2,22 @@
 
 #include <NosLib/HttpClient.hpp>
 
+#include "ConnectionPool.hpp"
+#include "InstallOptions.hpp"
+
 #include <string>
+#include <vector>
+#include <functional>
 #include <fstream>
 
+class LinkScanner;
+
 class ModDB
 {
 protected:
 	inline static ModDB* Instance = nullptr;
 
-	NosLib::HttpClient::ptr ModDBMirrorClient;
-
-	ModDB()
-	{
-		ModDBMirrorClient = NosLib::HttpClient::MakeClient("https://www.moddb.com");
-		ModDBMirrorClient->set_follow_location(false);
-		ModDBMirrorClient->set_keep_alive(true);
-	}
+	ModDB() {}
 
 	inline static void Initialize()
 	{
@@ -27,31 +27,33 @@ protected:
 		}
 	}
 public:
-	inline static NosLib::HttpClient::ptr CreateDownloadClient()
+	inline static const std::string HostUrl = "https://www.moddb.com";
+
+	inline static ConnectionPool::Lease CreateDownloadClient()
 	{
 		Initialize();
 
-		NosLib::HttpClient::ptr modDBDownloadClient;
-		modDBDownloadClient = NosLib::HttpClient::MakeClient("https://www.moddb.com");
-		modDBDownloadClient->set_follow_location(true);
-		modDBDownloadClient->set_keep_alive(true);
-		return modDBDownloadClient;
+		return ConnectionPool::Acquire(HostUrl);
 	}
 
 	inline static std::wstring GetDownloadString(const std::wstring& downloadLink)
 	{
 		Initialize();
 
+		/* Quickest Mirror resolves every mirror of the mod, which can make ModDB block the user. So it is opt in */
+		if (InstallOptions::ProbeMirrors)
+		{
+			return Instance->GetQuickestMirror(downloadLink);
+		}
+
 		return Instance->GetGivenMirror(downloadLink);
-		/* Quickest Mirror Currently makes ModDB block user */
-		//return Instance->GetQuickestMirror(downloadLink);
 	}
 protected:
 	std::wstring GetGivenMirror(const std::wstring& downloadLink);
 
 	std::wstring GetQuickestMirror(const std::wstring& downloadLink);
-	std::string GetPageContent(const std::string& downloadLink);
-	NosLib::DynamicArray<std::string> ExtractMirrors(const std::string& pageContent);
-	uint32_t PingMirror(const std::string& mirrorHostname);
-	std::string GetHostName(const std::string& downloadLink);
+	int GovernedRequest(const std::string& path, const std::function<int(httplib::Client*)>& request);
+	httplib::Result GovernedGet(const std::string& path);
+	bool ScanPage(const std::string& downloadLink, LinkScanner* scanner);
+	bool ResolveMirror(const std::string& mirrorLink, std::string* hostUrl, std::string* filePath);
 };
\ No newline at end of file
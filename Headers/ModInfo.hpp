@@ -26,6 +26,8 @@ public:
 	enum class WorkState : uint16_t
 	{
 		NotStarted,
+		Submitted,	/* handed to the pipeline, waiting on its file */
+		Ready,		/* file is ready, waiting in the install queue */
 		InProgress,
 		Completed
 	};
@@ -50,27 +52,52 @@ protected:
 	std::wstring CreatorName;						/* the creator name (used in folder name) */
 	std::wstring OutName;							/* the main folder name (use in folder name) */
 	std::wstring OriginalLink;						/* original mod link (I don't know why its there but I'll parse it anyway) */
+	std::wstring UpdateKey;							/* modpack maker mods only, see MakeUpdateKey */
 
 	/* Extra Mod Params */
 	std::wstring OutPath;							/* This is Custom modtype only, it defines were to copy the files to */
 	bool UseInstallPath = true;						/* If mod should include mod path when installing (ONLY FOR CUSTOM) */
 
 	/* MultiThreading */
-	inline static std::mutex PriorityMutex;
-	inline static std::condition_variable PriorityCV;
 	ModProcessorThread* ProcessingThread;
-	std::mutex WorkStateMutex;
 	std::atomic<WorkState> CurrentWorkState = WorkState::NotStarted;
+	std::atomic<bool> InstallFailed = false;		/* set by LogError, the mod still completes but some (or all) of its files are missing */
 	File* FileObject = nullptr;
+	File::Version InstalledVersion;					/* version of the file the mod was installed from, see ModpackUpdate::FindChangedFiles */
+
+	/* Dependencies */
+	NosLib::DynamicArray<ModInfo*> Dependents;		/* mods which can only be installed after this one */
+	std::atomic<int> InstallBlockers = 0;			/* what is still stopping the mod from being installed (unfinished dependencies, its file, not being submitted) */
 
 	/// <summary>
 	/// Needs to be run by all the constructors, initializes for loading screen
 	/// </summary>
 	void InitializeModInfo();
 
+	/// <summary>
+	/// inner paths this mod copies out of its file, and where each one goes
+	/// </summary>
+	/// <returns>the targets, in copying order</returns>
+	std::vector<File::ExtractTarget> GetExtractTargets();
+
+	/// <summary>
+	/// tells the file which inner paths this mod copies out, so only those get extracted
+	/// </summary>
+	void RegisterExtractPaths();
+
+	/// <summary>
+	/// tells the file this mod is done with it
+	/// </summary>
+	void ReleaseFile();
+
+	/// <summary>
+	/// installs the mod straight from its archive, for files which weren't extracted
+	/// </summary>
+	/// <returns>true if successful</returns>
+	bool InstallDirect();
+
 public:
 	inline static NosLib::DynamicArray<ModInfo*> ModInfoList; /* A list of all mods */
-	inline static NosLib::DynamicArray<ModInfo*> PriorityModList;
 
 protected:
 	/// <summary>
@@ -115,20 +142,135 @@ public:
 
 	std::wstring GetFolderName();
 
-	static ModInfo* AddMod(const std::wstring& link, NosLib::DynamicArray<std::wstring>& insidePaths, const std::wstring& outPath, const std::wstring& outName, const bool& priorityInstall = false, const bool& useInstallPath = true, const std::wstring& customExtension = L"");
-	static ModInfo* AddMod(const std::wstring& link, NosLib::DynamicArray<std::wstring>&& insidePaths, const std::wstring& outPath, const std::wstring& outName, const bool& priorityInstall = false, const bool& useInstallPath = true, const std::wstring& customExtension = L"");
+	/// <summary>
+	/// what the mod's files get recorded under in the InstallManifest. Unlike the folder name it is unique (custom mods share folders)
+	/// and doesn't change when the mod's prefix moves
+	/// </summary>
+	std::wstring GetOwnerKey();
+
+	std::wstring GetUpdateKey()
+	{
+		return UpdateKey;
+	}
+
+	File::Version GetInstalledVersion()
+	{
+		return InstalledVersion;
+	}
+
+	void SetInstalledVersion(const File::Version& version)
+	{
+		InstalledVersion = version;
+	}
+
+	/// <summary>
+	/// marks the mod as installed without installing it (already installed by an earlier install), the pipeline skips it
+	/// </summary>
+	void MarkUpToDate();
+
+	static ModInfo* AddMod(const std::wstring& link, NosLib::DynamicArray<std::wstring>& insidePaths, const std::wstring& outPath, const std::wstring& outName, NosLib::DynamicArray<ModInfo*> dependencies = {}, const bool& useInstallPath = true, const std::wstring& customExtension = L"");
+	static ModInfo* AddMod(const std::wstring& link, NosLib::DynamicArray<std::wstring>&& insidePaths, const std::wstring& outPath, const std::wstring& outName, NosLib::DynamicArray<ModInfo*> dependencies = {}, const bool& useInstallPath = true, const std::wstring& customExtension = L"");
+
+	/// <summary>
+	/// makes this mod wait for <paramref name="dependency"/> to be installed before installing itself (downloading and extracting still happen straight away)
+	/// </summary>
+	/// <param name="dependency">- mod that needs to be installed first</param>
+	void DependsOn(ModInfo* dependency);
+
+	NosLib::DynamicArray<ModInfo*>& GetDependents()
+	{
+		return Dependents;
+	}
+
+	void SetInstallBlockers(const int& blockers)
+	{
+		InstallBlockers = blockers;
+	}
+
+	void AddInstallBlocker()
+	{
+		InstallBlockers++;
+	}
+
+	/// <summary>
+	/// removes 1 thing that is stopping the mod from being installed
+	/// </summary>
+	/// <returns>true if that was the last one, the caller then queues the mod</returns>
+	bool ReleaseInstallBlocker()
+	{
+		return --InstallBlockers == 0;
+	}
+
+	WorkState GetModWorkState()
+	{
+		return CurrentWorkState.load();
+	}
+
+	/// <summary>
+	/// atomically moves the mod from one state to another, only 1 thread can ever win a transition so a mod can't be claimed twice
+	/// </summary>
+	/// <param name="from">- state the mod needs to be in</param>
+	/// <param name="to">- state to move it to</param>
+	/// <returns>true if this thread made the transition</returns>
+	bool TryTransition(const WorkState& from, const WorkState& to)
+	{
+		WorkState expected = from;
+		return CurrentWorkState.compare_exchange_strong(expected, to);
+	}
+
+	bool CheckIfFailed()
+	{
+		return InstallFailed.load();
+	}
 
-	WorkState GetModWorkState();
-	void WaitPriority(ModProcessorThread* processingThread);
+	/// <returns>true if the mod got installed (or was already) without any errors</returns>
+	bool CheckIfInstalled()
+	{
+		return CurrentWorkState.load() == WorkState::Completed && !InstallFailed.load();
+	}
 
 	void ProcessMod(ModProcessorThread* processingThread);
 
+	File* GetFileObject()
+	{
+		return FileObject;
+	}
+
+	/// <summary>
+	/// download stage, gets the mods file (which might be shared with other mods)
+	/// </summary>
+	/// <param name="processingThread">- thread to show progress on</param>
+	/// <returns>true if the file is ready to extract</returns>
+	bool DownloadModFile(ModProcessorThread* processingThread);
+
+	/// <summary>
+	/// extract stage, extracts the mods file (which might be shared with other mods)
+	/// </summary>
+	/// <param name="processingThread">- thread to show progress on</param>
+	/// <returns>true if the file is ready to be installed from</returns>
+	bool ExtractModFile(ModProcessorThread* processingThread);
+
 	/// <summary>
 	/// takes in a filename for a modpackMaker and parses it fully
 	/// </summary>
 	/// <param name="modpackMakerFileName">(default = "modpack_maker_list.txt") - path/name of modpack Maker</param>
+	/// <param name="dependencies">- mods that every parsed mod needs installed first</param>
 	/// <returns>a DynamicArray of ModInfo pointers (ModInfo*)</returns>
-	static void ModpackMakerFile_Parse(const std::wstring& modpackMakerFileName);
+	static NosLib::DynamicArray<ModInfo*> ModpackMakerFile_Parse(const std::wstring& modpackMakerFileName, NosLib::DynamicArray<ModInfo*> dependencies = {});
+
+	/// <summary>
+	/// splits a modpack maker line into its info and inner paths
+	/// </summary>
+	/// <param name="line">- input line</param>
+	/// <param name="wordArray">- gets the tab separated info</param>
+	/// <param name="pathArray">- gets the inner paths, normalized (always start and end with "\\", root always included)</param>
+	/// <returns>false if the line is a separator (only has a name)</returns>
+	static bool SplitLine(std::wstring& line, NosLib::DynamicArray<std::wstring>* wordArray, NosLib::DynamicArray<std::wstring>* pathArray);
+
+	/// <summary>
+	/// identifies a modpack maker mod between modpack versions, same key means the mod installs the same files
+	/// </summary>
+	static std::wstring MakeUpdateKey(NosLib::DynamicArray<std::wstring>& wordArray, NosLib::DynamicArray<std::wstring>& pathArray, const bool& separator);
 
 protected:
 	/// <summary>
@@ -140,6 +282,7 @@ protected:
 
 	void UpdateLoadingScreen(const std::wstring& status);
 	void UpdateLoadingScreen(const int& percentageOnCurrentMod);
+	void UpdateLoadingScreen(const uint64_t& done, const uint64_t& total);
 	void UpdateLoadingScreen(const int& percentageOnCurrentMod, const std::wstring& status);
 
 	void LogError(const std::wstring& errorMessage, const std::source_location& errorLocation);
@@ -1,41 +1,34 @@
 #pragma once
 
-#include <QProgressBar>
-#include <QObject>
+#include "ProgressSlot.hpp"
 
-#include <mutex>
-#include <atomic>
+#include <string>
+#include <memory>
 
-class ProgressStatus;
-
-/* Each class instance is a thread */
-class ModProcessorThread : public QObject
+/* Each class instance is a pipeline worker thread, and its progress bar */
+class ModProcessorThread
 {
-	Q_OBJECT
-signals:
-	void ModUpdateProgress(const int&);
-	void ModUpdateStatus(const std::wstring&);
-
 public:
+	/* only stores the progress, the progress bar picks it up on its own */
 	void UpdateModProgress(const int& value)
 	{
-		emit ModUpdateProgress(value);
+		Slot->SetPercentage(value);
+	}
+
+	void UpdateModProgress(const uint64_t& done, const uint64_t& total)
+	{
+		Slot->SetProgress(done, total);
 	}
 
 	void UpdateModStatus(const std::wstring& value)
 	{
-		emit ModUpdateStatus(value);
+		Slot->SetStatus(value);
 	}
 
 protected:
-	inline static std::atomic<int> ModCount = 0;
-	inline static std::atomic<int> CompleteCount = 0;
-
-	ProgressStatus* RegisteredStatusProgress = nullptr;
+	std::shared_ptr<ProgressSlot> Slot;
 
 public:
 	ModProcessorThread();
 	~ModProcessorThread();
-
-	void ProcessMod();
 };
\ No newline at end of file
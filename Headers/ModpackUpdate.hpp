@@ -0,0 +1,54 @@
+#pragma once
+
+#include <NosLib/DynamicArray.hpp>
+
+#include <string>
+#include <unordered_set>
+
+class ModInfo;
+
+/// <summary>
+/// Updates an existing install by comparing the new modpack maker list with the one recorded by the last install.
+/// Unchanged mods are kept (renamed if their prefix moved), removed and changed mods get their old folder deleted, only new and changed mods get installed
+/// </summary>
+namespace ModpackUpdate
+{
+	/* copy of the modpack maker list the install was made from, inside the install directory */
+	inline const std::wstring InstalledListName = L"modpack_maker_list.installed.txt";
+
+	/* update keys (ModInfo::GetUpdateKey) of the mods from the installed list which failed to install, 1 per line */
+	inline const std::wstring FailedListName = L"modpack_maker_list.failed.txt";
+
+	/* owner key (ModInfo::GetOwnerKey), ETag and Last-Modified of the installed mods from outside of the list, tab separated, 1 per line */
+	inline const std::wstring VersionListName = L"modpack_extras.installed.txt";
+
+	/// <summary>
+	/// checks if there is a recorded install to update from
+	/// </summary>
+	bool CanUpdate(const std::wstring& installPath);
+
+	/// <summary>
+	/// asks the server if the files of <paramref name="mods"/> (mods from outside of the list, like the setup files) changed since they were installed.
+	/// Unchanged mods get their recorded version back, so it gets recorded again if they are kept
+	/// </summary>
+	/// <param name="installPath">- GAMMA install directory</param>
+	/// <param name="mods">- mods to check</param>
+	/// <returns>owner keys of the mods which changed, or have no recorded version</returns>
+	std::unordered_set<std::wstring> FindChangedFiles(const std::wstring& installPath, NosLib::DynamicArray<ModInfo*>& mods);
+
+	/// <summary>
+	/// diffs <paramref name="parsedMods"/> against the recorded list, deletes and renames the old mod folders and marks unchanged mods as up to date
+	/// </summary>
+	/// <param name="installPath">- GAMMA install directory</param>
+	/// <param name="parsedMods">- mods parsed from the new modpack maker list, in file order</param>
+	/// <param name="forceInstall">- owner keys of mods which get installed even if unchanged (damaged ones, see InstallRepair)</param>
+	void ApplyDiff(const std::wstring& installPath, NosLib::DynamicArray<ModInfo*>& parsedMods, const std::unordered_set<std::wstring>& forceInstall = {});
+
+	/// <summary>
+	/// records the modpack maker list the install was just made from, which of its mods failed and the versions of the mods from outside of it, for the next update
+	/// </summary>
+	/// <param name="installPath">- GAMMA install directory</param>
+	/// <param name="modpackMakerListPath">- modpack maker list the install was made from</param>
+	/// <param name="mods">- every mod of the install, after installing</param>
+	void RecordInstalledList(const std::wstring& installPath, const std::wstring& modpackMakerListPath, NosLib::DynamicArray<ModInfo*>& mods);
+}
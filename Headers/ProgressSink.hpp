@@ -0,0 +1,25 @@
+#pragma once
+
+#include "ProgressSlot.hpp"
+
+#include <memory>
+
+/// <summary>
+/// Where worker progress goes, the progress bars of the installer window or the console when running headless
+/// </summary>
+class ProgressSink
+{
+public:
+	virtual ~ProgressSink() {}
+
+	/// <summary>
+	/// hands out a progress slot for a worker straight away. Safe to call from any thread
+	/// </summary>
+	/// <returns>the slot to write progress into</returns>
+	virtual std::shared_ptr<ProgressSlot> RegisterProgressBar() = 0;
+
+	/// <summary>
+	/// the worker is done with the slot, doesn't wait for the sink
+	/// </summary>
+	virtual void UnregisterProgressBar(const std::shared_ptr<ProgressSlot>& slot) = 0;
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+/// <summary>
+/// Progress of 1 worker, written by the worker and read by whatever displays it (at its own pace).
+/// Progress updates are 2 relaxed stores, so they are cheap enough to do for every downloaded chunk
+/// </summary>
+class ProgressSlot
+{
+protected:
+	std::atomic<uint64_t> Done = 0;
+	std::atomic<uint64_t> Total = 0; /* 0 means unknown (chunked transfers) */
+
+	std::mutex StatusMutex;
+	std::wstring Status;
+	std::atomic<uint32_t> StatusVersion = 0; /* goes up with every status change, so readers only copy it when it changed */
+
+public:
+	/* worker side */
+
+	void SetProgress(const uint64_t& done, const uint64_t& total)
+	{
+		Done.store(done, std::memory_order_relaxed);
+		Total.store(total, std::memory_order_relaxed);
+	}
+
+	void SetPercentage(const int& percentage)
+	{
+		SetProgress(percentage, 100);
+	}
+
+	void SetStatus(const std::wstring& status)
+	{
+		std::lock_guard<std::mutex> lk(StatusMutex);
+		Status = status;
+		StatusVersion.fetch_add(1, std::memory_order_release);
+	}
+
+	/* display side */
+
+	/// <returns>0 to 100, or -1 if there is progress but the total isn't known</returns>
+	int GetPercentage() const
+	{
+		uint64_t done = Done.load(std::memory_order_relaxed);
+		uint64_t total = Total.load(std::memory_order_relaxed);
+
+		if (total == 0)
+		{
+			return (done == 0 ? 0 : -1);
+		}
+
+		return (done >= total ? 100 : static_cast<int>((done * 100) / total));
+	}
+
+	uint64_t GetDone() const
+	{
+		return Done.load(std::memory_order_relaxed);
+	}
+
+	uint64_t GetTotal() const
+	{
+		return Total.load(std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// copies the status if it changed since <paramref name="seenVersion"/>
+	/// </summary>
+	/// <param name="seenVersion">- version the reader last saw, gets updated</param>
+	/// <param name="status">- gets set to the status</param>
+	/// <returns>true if the status changed</returns>
+	bool GetStatusIfChanged(uint32_t* seenVersion, std::wstring* status)
+	{
+		if (StatusVersion.load(std::memory_order_acquire) == *seenVersion)
+		{
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lk(StatusMutex);
+		*seenVersion = StatusVersion.load(std::memory_order_relaxed);
+		*status = Status;
+		return true;
+	}
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/// <summary>
+/// Installs whole directory trees. The source gets walked once, the directories get created up front and the files get spread over a few workers
+/// (trees smaller than FilesPerWorker files stay on the calling thread)
+/// </summary>
+class TreeCopier
+{
+protected:
+	struct FileJob
+	{
+		std::filesystem::path From;
+		std::filesystem::path To;
+		uint64_t Size;
+
+		FileJob(const std::filesystem::path& from, const std::filesystem::path& to, const uint64_t& size) : From(from), To(to), Size(size) {}
+	};
+
+	inline static constexpr int WorkerCount = 4;			/* per tree, mods already get installed InstallOptions::InstallThreads at a time */
+	inline static constexpr size_t FilesPerWorker = 16;		/* smaller trees aren't worth starting threads for */
+
+	static void CollectJobs(const std::filesystem::path& from, const std::filesystem::path& to, const bool& recursive, std::vector<FileJob>* jobs);
+	static void RunJobs(const std::vector<FileJob>& jobs, const std::wstring& owner);
+
+public:
+	/// <summary>
+	/// same as std::filesystem::copy with overwrite_existing, but every file goes through FileLinking::InstallFile
+	/// </summary>
+	/// <param name="from">- source file or directory</param>
+	/// <param name="to">- target directory</param>
+	/// <param name="recursive">- if sub directories get installed as well</param>
+	/// <param name="owner">- mod installing the files</param>
+	static void InstallTree(const std::filesystem::path& from, const std::filesystem::path& to, const bool& recursive, const std::wstring& owner);
+};
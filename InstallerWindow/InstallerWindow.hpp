@@ -3,12 +3,15 @@
 #include <QtWidgets/QMainWindow>
 #include <QtWidgets/QPushButton>
 #include <QString>
+#include <QTimer>
 
 #include <NosLib/Logging.hpp>
 
 #include "../Headers/Validation.hpp"
 #include "../Headers/InstallManager.hpp"
 #include "../Headers/Version.hpp"
+#include "../Headers/BandwidthLimiter.hpp"
+#include "../Headers/InstallEstimator.hpp"
 
 #include "ui_InstallerWindow.h"
 
@@ -68,6 +71,37 @@ public:
 			InstallOptions::AddOverwriteFiles = (state == Qt::Checked);
 		});
 
+		connect(ui.OptionUpdateExistingInstall, &QCheckBox::checkStateChanged, this, [&](Qt::CheckState state)
+		{
+			InstallOptions::UpdateExistingInstall = (state == Qt::Checked);
+		});
+
+		connect(ui.OptionVerifyExistingInstall, &QCheckBox::checkStateChanged, this, [&](Qt::CheckState state)
+		{
+			InstallOptions::VerifyExistingInstall = (state == Qt::Checked);
+		});
+
+		connect(ui.OptionUseHardlinks, &QCheckBox::checkStateChanged, this, [&](Qt::CheckState state)
+		{
+			InstallOptions::UseHardlinks = (state == Qt::Checked);
+		});
+
+		connect(ui.OptionUseArchiveCache, &QCheckBox::checkStateChanged, this, [&](Qt::CheckState state)
+		{
+			InstallOptions::UseArchiveCache = (state == Qt::Checked);
+		});
+
+		connect(ui.OptionProbeMirrors, &QCheckBox::checkStateChanged, this, [&](Qt::CheckState state)
+		{
+			InstallOptions::ProbeMirrors = (state == Qt::Checked);
+		});
+
+		/* Download limit, applies straight away (even to downloads already running) */
+		connect(ui.DownloadLimitSpinBox, &QSpinBox::valueChanged, this, [&](int megabytesPerSecond)
+		{
+			BandwidthLimiter::SetGlobalRate(static_cast<uint64_t>(megabytesPerSecond) * 1024 * 1024);
+		});
+
 		/* Install Start */
 		connect(ui.StartInstallButton, &QPushButton::released, this, &InstallerWindow::PreStartInstall);
 
@@ -151,6 +185,7 @@ protected:
 	}
 
 	QThread* InstallThread;
+	QTimer EstimateTimer;
 
 	inline void StartInstall()
 	{
@@ -164,7 +199,9 @@ protected:
 		connect(InstallClass, &InstallManager::FinishInstallerInitializing, this, &InstallerWindow::FinishInstallerInitializing);
 		connect(InstallClass, &InstallManager::FinishInstalling, this, &InstallerWindow::FinishInstalling);
 
-		connect(InstallClass, &InstallManager::TotalUpdateProgress, this, &InstallerWindow::TotalUpdateProgress);
+		/* total progress, time left and speeds come from the InstallEstimator, once a second is plenty for them */
+		EstimateTimer.setInterval(1000);
+		connect(&EstimateTimer, &QTimer::timeout, this, &InstallerWindow::UpdateEstimate);
 
 		ui.TotalProgressBar->setValue(0);
 		ui.TotalProgressBar->setMaximum(0);
@@ -179,16 +216,34 @@ public slots:
 	{
 		ui.TotalProgressBar->setValue(0);
 		ui.TotalProgressBar->setMaximum(100);
+		EstimateTimer.start();
 	}
 
 	void FinishInstalling(const std::wstring& timeTakenString)
 	{
+		EstimateTimer.stop();
 		ui.stackedWidget->setCurrentIndex(2);
 		ui.TimeTakenLabel->setText(QString::fromStdWString(timeTakenString));
 	}
 
-	void TotalUpdateProgress(const int& newProgress)
+	void UpdateEstimate()
 	{
-		ui.TotalProgressBar->setValue(newProgress);
+		InstallEstimator::Estimate estimate = InstallEstimator::Sample();
+
+		ui.TotalProgressBar->setValue(estimate.Percentage);
+
+		if (estimate.SecondsLeft < 0)
+		{
+			ui.EtaLabel->setText("Time Left: Estimating...");
+		}
+		else
+		{
+			int minutesLeft = static_cast<int>(estimate.SecondsLeft / 60) + 1;
+			ui.EtaLabel->setText(QString::fromStdWString(std::format(L"Time Left: {}h {:02}m", minutesLeft / 60, minutesLeft % 60)));
+		}
+
+		ui.SpeedLabel->setText(QString::fromStdWString(std::format(L"Download: {:.1f} MB/s | Extract: {:.1f} MB/s",
+																   estimate.DownloadBytesPerSecond / (1024 * 1024),
+																   estimate.ExtractBytesPerSecond / (1024 * 1024))));
 	}
 };
\ No newline at end of file
@@ -0,0 +1,373 @@
+#include "../Headers/ArchiveCache.hpp"
+#include "../Headers/Hash.hpp"
+
+#include <NosLib/Logging.hpp>
+#include <NosLib/String.hpp>
+
+#include <fstream>
+#include <filesystem>
+#include <sstream>
+#include <format>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+
+static uint64_t currentTime()
+{
+	return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+bool ArchiveCache::Entry::Matches(const std::string& eTag, const std::string& lastModified, const uint64_t& contentLength) const
+{
+	if (ContentLength != contentLength)
+	{
+		return false;
+	}
+
+	/* without a validator there is no way to tell if the file changed on the server */
+	if (!eTag.empty())
+	{
+		return ETag == eTag;
+	}
+
+	if (!lastModified.empty())
+	{
+		return LastModified == lastModified;
+	}
+
+	return false;
+}
+
+void ArchiveCache::Initialize(const std::wstring& cacheDirectory, const uint64_t& sizeLimit)
+{
+	std::lock_guard<std::mutex> lk(CacheMutex);
+
+	CacheDirectory = (cacheDirectory.empty() ? GetDefaultDirectory() : cacheDirectory);
+	if (CacheDirectory.back() != L'\\' && CacheDirectory.back() != L'/')
+	{
+		CacheDirectory += L"\\";
+	}
+
+	SizeLimit = sizeLimit;
+
+	std::error_code ec;
+	std::filesystem::create_directories(CacheDirectory, ec);
+	if (ec)
+	{
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"error: \"{}\" When trying to create archive cache directory, cache disabled", NosLib::String::ToWstring(ec.message())), NosLib::Logging::Severity::Error);
+		return;
+	}
+
+	LoadIndex();
+	Enabled = true;
+
+	NosLib::Logging::CreateLog<wchar_t>(std::format(L"Archive cache at \"{}\" with {} archives", CacheDirectory, Entries.size()), NosLib::Logging::Severity::Info);
+}
+
+std::wstring ArchiveCache::GetDefaultDirectory()
+{
+	#ifdef _WIN32
+	wchar_t* localAppData = nullptr;
+	size_t length = 0;
+	if (_wdupenv_s(&localAppData, &length, L"LOCALAPPDATA") == 0 && localAppData != nullptr)
+	{
+		std::wstring directory = std::format(L"{}\\NorzkasGammaInstaller\\ArchiveCache\\", localAppData);
+		free(localAppData);
+		return directory;
+	}
+	#else
+	const char* home = std::getenv("HOME");
+	if (home != nullptr)
+	{
+		return NosLib::String::ToWstring(std::format("{}/.cache/NorzkasGammaInstaller/ArchiveCache/", home));
+	}
+	#endif // _WIN32
+
+	return L"ArchiveCache\\";
+}
+
+bool ArchiveCache::Find(const std::wstring& url, Entry* entry)
+{
+	std::lock_guard<std::mutex> lk(CacheMutex);
+
+	auto found = Entries.find(url);
+	if (found == Entries.end())
+	{
+		return false;
+	}
+
+	/* index can outlive the archive (deleted by hand) */
+	if (!std::filesystem::exists(GetObjectPath(found->second)))
+	{
+		Entries.erase(found);
+		return false;
+	}
+
+	*entry = found->second;
+	return true;
+}
+
+bool ArchiveCache::Restore(const Entry& entry, const std::wstring& targetPath)
+{
+	std::wstring objectPath = GetObjectPath(entry);
+
+	std::error_code ec;
+	std::filesystem::remove(targetPath, ec);
+
+	/* archives only get read, so sharing the data with the cache is safe. Links fail across drives, copying is the fallback */
+	std::filesystem::create_hard_link(objectPath, targetPath, ec);
+	if (ec)
+	{
+		std::filesystem::copy_file(objectPath, targetPath, std::filesystem::copy_options::overwrite_existing, ec);
+		if (ec)
+		{
+			NosLib::Logging::CreateLog<wchar_t>(std::format(L"error: \"{}\" When trying to restore \"{}\" from the archive cache", NosLib::String::ToWstring(ec.message()), entry.Url), NosLib::Logging::Severity::Error);
+			return false;
+		}
+	}
+
+	std::lock_guard<std::mutex> lk(CacheMutex);
+
+	auto found = Entries.find(entry.Url);
+	if (found != Entries.end())
+	{
+		found->second.LastUsed = currentTime();
+		SaveIndex();
+	}
+
+	NosLib::Logging::CreateLog<wchar_t>(std::format(L"Restored \"{}\" from the archive cache", entry.Url), NosLib::Logging::Severity::Info);
+	return true;
+}
+
+bool ArchiveCache::Store(Entry entry, const std::wstring& filePath)
+{
+	if (!XXH64Hasher::HashFile(filePath, &entry.Hash))
+	{
+		return false;
+	}
+
+	std::wstring objectPath = GetObjectPath(entry);
+
+	/* same contents might already be stored for another link */
+	std::error_code ec;
+	if (!std::filesystem::exists(objectPath))
+	{
+		std::filesystem::create_hard_link(filePath, objectPath, ec);
+		if (ec)
+		{
+			std::filesystem::copy_file(filePath, objectPath, std::filesystem::copy_options::overwrite_existing, ec);
+			if (ec)
+			{
+				NosLib::Logging::CreateLog<wchar_t>(std::format(L"error: \"{}\" When trying to add \"{}\" to the archive cache", NosLib::String::ToWstring(ec.message()), entry.Url), NosLib::Logging::Severity::Error);
+				return false;
+			}
+		}
+	}
+
+	std::lock_guard<std::mutex> lk(CacheMutex);
+	AddEntry(entry);
+	return true;
+}
+
+bool ArchiveCache::Store(Entry entry, const std::vector<unsigned char>& buffer)
+{
+	XXH64Hasher hasher;
+	hasher.Update(buffer.data(), buffer.size());
+	entry.Hash = hasher.HexDigest();
+
+	std::wstring objectPath = GetObjectPath(entry);
+
+	if (!std::filesystem::exists(objectPath))
+	{
+		/* write next to the object and swap, a half written archive must never look like a cached one */
+		std::wstring tempPath = objectPath + L".tmp";
+		{
+			std::ofstream objectFile(tempPath, std::ios::binary | std::ios::trunc);
+			objectFile.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+
+			if (!objectFile.good())
+			{
+				return false;
+			}
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(tempPath, objectPath, ec);
+		if (ec)
+		{
+			NosLib::Logging::CreateLog<wchar_t>(std::format(L"error: \"{}\" When trying to add \"{}\" to the archive cache", NosLib::String::ToWstring(ec.message()), entry.Url), NosLib::Logging::Severity::Error);
+			return false;
+		}
+	}
+
+	std::lock_guard<std::mutex> lk(CacheMutex);
+	AddEntry(entry);
+	return true;
+}
+
+std::wstring ArchiveCache::GetObjectPath(const Entry& entry)
+{
+	return CacheDirectory + NosLib::String::ToWstring(entry.Hash) + entry.FileExtension;
+}
+
+std::wstring ArchiveCache::GetIndexPath()
+{
+	return CacheDirectory + L"index.txt";
+}
+
+void ArchiveCache::AddEntry(const Entry& entry)
+{
+	Entries[entry.Url] = entry;
+	Entries[entry.Url].LastUsed = currentTime();
+
+	Evict();
+	SaveIndex();
+
+	NosLib::Logging::CreateLog<wchar_t>(std::format(L"Added \"{}\" to the archive cache", entry.Url), NosLib::Logging::Severity::Info);
+}
+
+void ArchiveCache::Evict()
+{
+	/* archives can be shared between links, size and users are counted per stored archive */
+	std::unordered_map<std::wstring, uint64_t> objectSizes;
+	std::unordered_map<std::wstring, int> objectUsers;
+	uint64_t totalSize = 0;
+
+	for (auto& [url, entry] : Entries)
+	{
+		std::wstring objectPath = GetObjectPath(entry);
+
+		if (objectUsers[objectPath]++ == 0)
+		{
+			objectSizes[objectPath] = entry.ContentLength;
+			totalSize += entry.ContentLength;
+		}
+	}
+
+	if (totalSize <= SizeLimit)
+	{
+		return;
+	}
+
+	std::vector<Entry> byAge;
+	for (auto& [url, entry] : Entries)
+	{
+		byAge.push_back(entry);
+	}
+
+	std::sort(byAge.begin(), byAge.end(), [](const Entry& left, const Entry& right)
+	{
+		return left.LastUsed < right.LastUsed;
+	});
+
+	for (const Entry& entry : byAge)
+	{
+		if (totalSize <= SizeLimit)
+		{
+			break;
+		}
+
+		std::wstring objectPath = GetObjectPath(entry);
+		Entries.erase(entry.Url);
+
+		/* still used by another link */
+		if (--objectUsers[objectPath] > 0)
+		{
+			continue;
+		}
+
+		std::error_code ec;
+		std::filesystem::remove(objectPath, ec);
+		totalSize -= objectSizes[objectPath];
+
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"Removed \"{}\" from the archive cache", entry.Url), NosLib::Logging::Severity::Info);
+	}
+}
+
+void ArchiveCache::LoadIndex()
+{
+	Entries.clear();
+
+	std::ifstream indexFile(GetIndexPath(), std::ios::binary);
+	if (!indexFile.is_open())
+	{
+		return;
+	}
+
+	/* one entry per line, tab separated: url, etag, last modified, length, extension, hash, last used */
+	std::string line;
+	while (std::getline(indexFile, line))
+	{
+		std::vector<std::string> fields;
+		std::istringstream lineStream(line);
+		std::string field;
+		while (std::getline(lineStream, field, '\t'))
+		{
+			fields.push_back(field);
+		}
+
+		if (fields.size() != 7)
+		{
+			continue;
+		}
+
+		Entry entry;
+		entry.Url = NosLib::String::ToWstring(fields[0]);
+		entry.ETag = fields[1];
+		entry.LastModified = fields[2];
+		entry.FileExtension = NosLib::String::ToWstring(fields[4]);
+		entry.Hash = fields[5];
+
+		/* damaged entry, the archive just gets downloaded again */
+		try
+		{
+			entry.ContentLength = std::stoull(fields[3]);
+			entry.LastUsed = std::stoull(fields[6]);
+		}
+		catch (const std::exception&)
+		{
+			NosLib::Logging::CreateLog<wchar_t>(std::format(L"Skipping invalid archive cache entry for \"{}\"", entry.Url), NosLib::Logging::Severity::Warning);
+			continue;
+		}
+
+		Entries[entry.Url] = entry;
+	}
+}
+
+bool ArchiveCache::SaveIndex()
+{
+	std::string indexContent;
+	for (auto& [url, entry] : Entries)
+	{
+		indexContent += std::format("{}\t{}\t{}\t{}\t{}\t{}\t{}\n",
+									NosLib::String::ToString(entry.Url),
+									entry.ETag,
+									entry.LastModified,
+									entry.ContentLength,
+									NosLib::String::ToString(entry.FileExtension),
+									entry.Hash,
+									entry.LastUsed);
+	}
+
+	/* write next to the index and swap, so a crash mid write doesn't lose the whole cache */
+	std::wstring tempPath = GetIndexPath() + L".tmp";
+	{
+		std::ofstream indexFile(tempPath, std::ios::binary | std::ios::trunc);
+		indexFile.write(indexContent.c_str(), indexContent.size());
+
+		if (!indexFile.good())
+		{
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tempPath, GetIndexPath(), ec);
+	if (ec)
+	{
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"error: \"{}\" When trying to save archive cache index", NosLib::String::ToWstring(ec.message())), NosLib::Logging::Severity::Error);
+		return false;
+	}
+
+	return true;
+}
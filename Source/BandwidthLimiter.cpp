@@ -0,0 +1,146 @@
+#include "../Headers/BandwidthLimiter.hpp"
+
+#include <thread>
+#include <ctime>
+
+bool BandwidthLimiter::ScheduleWindow::Contains(const int& hour) const
+{
+	if (StartHour <= EndHour)
+	{
+		return hour >= StartHour && hour < EndHour;
+	}
+
+	/* over midnight */
+	return hour >= StartHour || hour < EndHour;
+}
+
+void BandwidthLimiter::SetGlobalRate(const uint64_t& bytesPerSecond)
+{
+	std::lock_guard<std::mutex> lk(LimiterMutex);
+	GlobalRate = bytesPerSecond;
+}
+
+uint64_t BandwidthLimiter::GetGlobalRate()
+{
+	std::lock_guard<std::mutex> lk(LimiterMutex);
+	return GlobalRate;
+}
+
+void BandwidthLimiter::SetHostRate(const std::string& hostUrl, const uint64_t& bytesPerSecond)
+{
+	std::lock_guard<std::mutex> lk(LimiterMutex);
+
+	std::unique_ptr<Bucket>& bucket = HostBuckets[hostUrl];
+	if (bucket == nullptr)
+	{
+		bucket = std::make_unique<Bucket>();
+	}
+
+	std::lock_guard<std::mutex> bucketLock(bucket->BucketMutex);
+	bucket->Rate = bytesPerSecond;
+}
+
+void BandwidthLimiter::SetSchedule(const std::vector<ScheduleWindow>& schedule)
+{
+	std::lock_guard<std::mutex> lk(LimiterMutex);
+	Schedule = schedule;
+}
+
+void BandwidthLimiter::Consume(const std::string& hostUrl, const uint64_t& bytes)
+{
+	ConsumeFrom(&GlobalBucket, GetEffectiveGlobalRate(), bytes);
+
+	Bucket* hostBucket = FindHostBucket(hostUrl);
+	if (hostBucket != nullptr)
+	{
+		uint64_t hostRate;
+		{
+			std::lock_guard<std::mutex> lk(hostBucket->BucketMutex);
+			hostRate = hostBucket->Rate;
+		}
+
+		ConsumeFrom(hostBucket, hostRate, bytes);
+	}
+}
+
+uint64_t BandwidthLimiter::GetEffectiveGlobalRate()
+{
+	std::lock_guard<std::mutex> lk(LimiterMutex);
+
+	if (Schedule.empty())
+	{
+		return GlobalRate;
+	}
+
+	std::time_t now = std::time(nullptr);
+	std::tm localTime;
+	#ifdef _WIN32
+	localtime_s(&localTime, &now);
+	#else
+	localtime_r(&now, &localTime);
+	#endif // _WIN32
+
+	for (const ScheduleWindow& window : Schedule)
+	{
+		if (window.Contains(localTime.tm_hour))
+		{
+			return window.BytesPerSecond;
+		}
+	}
+
+	return GlobalRate;
+}
+
+BandwidthLimiter::Bucket* BandwidthLimiter::FindHostBucket(const std::string& hostUrl)
+{
+	std::lock_guard<std::mutex> lk(LimiterMutex);
+
+	auto found = HostBuckets.find(hostUrl);
+	return (found == HostBuckets.end() ? nullptr : found->second.get());
+}
+
+void BandwidthLimiter::ConsumeFrom(Bucket* bucket, const uint64_t& rate, const uint64_t& bytes)
+{
+	if (rate == 0)
+	{
+		return;
+	}
+
+	std::unique_lock<std::mutex> lk(bucket->BucketMutex);
+
+	/* the bytes already arrived, so they always get taken. The bucket goes into debt and everyone waits until it's paid back */
+	bool takenOut = false;
+	while (true)
+	{
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		double burstSize = rate * BurstSeconds;
+
+		bucket->Tokens += std::chrono::duration<double>(now - bucket->LastRefill).count() * rate;
+		bucket->Tokens = (bucket->Tokens > burstSize ? burstSize : bucket->Tokens);
+		bucket->LastRefill = now;
+
+		if (!takenOut)
+		{
+			bucket->Tokens -= static_cast<double>(bytes);
+			takenOut = true;
+		}
+
+		if (bucket->Tokens >= 0)
+		{
+			return;
+		}
+
+		std::chrono::milliseconds wait(static_cast<long long>((-bucket->Tokens / rate) * 1000) + 1);
+
+		lk.unlock();
+		std::this_thread::sleep_for(wait < MaxWaitSlice ? wait : MaxWaitSlice);
+		lk.lock();
+
+		/* limit got lifted while waiting */
+		if (bucket == &GlobalBucket ? GetEffectiveGlobalRate() == 0 : bucket->Rate == 0)
+		{
+			bucket->Tokens = 0;
+			return;
+		}
+	}
+}
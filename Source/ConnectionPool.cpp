@@ -0,0 +1,72 @@
+#include "../Headers/ConnectionPool.hpp"
+
+#include <NosLib/Logging.hpp>
+#include <NosLib/String.hpp>
+
+#include <format>
+
+void ConnectionPool::Lease::Release()
+{
+	if (Client == nullptr)
+	{
+		return;
+	}
+
+	ConnectionPool::Return(PoolKey, std::move(Client));
+	Client = nullptr;
+}
+
+ConnectionPool::Lease ConnectionPool::Acquire(const std::string& hostUrl, const bool& followLocation)
+{
+	std::string poolKey = std::format("{}|{}", hostUrl, (followLocation ? "follow" : "nofollow"));
+
+	{
+		std::lock_guard<std::mutex> lk(PoolMutex);
+
+		std::vector<NosLib::HttpClient::ptr>& idleClients = IdleClients[poolKey];
+
+		if (!idleClients.empty())
+		{
+			NosLib::HttpClient::ptr client = std::move(idleClients.back());
+			idleClients.pop_back();
+
+			/* the server might have closed the connection while it was idle, then the client just reconnects */
+			if (client->is_socket_open())
+			{
+				HandshakesSaved++;
+			}
+
+			return Lease(std::move(client), poolKey);
+		}
+	}
+
+	NosLib::HttpClient::ptr client = NosLib::HttpClient::MakeClient(hostUrl);
+	client->set_follow_location(followLocation);
+	client->set_keep_alive(true);
+
+	ClientsCreated++;
+	NosLib::Logging::CreateLog<wchar_t>(std::format(L"Created client for \"{}\" ({} created, {} handshakes saved)", NosLib::String::ToWstring(hostUrl), ClientsCreated.load(), HandshakesSaved.load()), NosLib::Logging::Severity::Debug);
+
+	return Lease(std::move(client), poolKey);
+}
+
+void ConnectionPool::Clear()
+{
+	std::lock_guard<std::mutex> lk(PoolMutex);
+	IdleClients.clear();
+}
+
+void ConnectionPool::Return(const std::string& poolKey, NosLib::HttpClient::ptr&& client)
+{
+	std::lock_guard<std::mutex> lk(PoolMutex);
+
+	std::vector<NosLib::HttpClient::ptr>& idleClients = IdleClients[poolKey];
+
+	/* pool is full, the client (and its connection) gets closed */
+	if (idleClients.size() >= MaxIdlePerHost)
+	{
+		return;
+	}
+
+	idleClients.push_back(std::move(client));
+}
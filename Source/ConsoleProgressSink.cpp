@@ -0,0 +1,223 @@
+#include "../Headers/ConsoleProgressSink.hpp"
+#include "../Headers/InstallEstimator.hpp"
+
+#include <NosLib/String.hpp>
+
+#include <iostream>
+#include <format>
+
+/* JSON string contents, quotes and control characters escaped */
+static std::string escapeJson(const std::string& text)
+{
+	std::string out;
+	out.reserve(text.size());
+
+	for (char character : text)
+	{
+		switch (character)
+		{
+		case '"':
+			out += "\\\"";
+			break;
+		case '\\':
+			out += "\\\\";
+			break;
+		case '\n':
+			out += "\\n";
+			break;
+		case '\r':
+			out += "\\r";
+			break;
+		case '\t':
+			out += "\\t";
+			break;
+		default:
+			if (static_cast<unsigned char>(character) < 0x20)
+			{
+				out += std::format("\\u{:04x}", static_cast<int>(character));
+			}
+			else
+			{
+				out += character;
+			}
+			break;
+		}
+	}
+
+	return out;
+}
+
+ConsoleProgressSink::ConsoleProgressSink(const Format& outputFormat, const std::chrono::milliseconds& interval)
+{
+	OutputFormat = outputFormat;
+	Interval = interval;
+
+	ReportThread = std::thread(&ConsoleProgressSink::ReportLoop, this);
+}
+
+ConsoleProgressSink::~ConsoleProgressSink()
+{
+	{
+		std::lock_guard<std::mutex> lk(SinkMutex);
+		Stopping = true;
+	}
+
+	StopSignal.notify_all();
+
+	if (ReportThread.joinable())
+	{
+		ReportThread.join();
+	}
+}
+
+std::shared_ptr<ProgressSlot> ConsoleProgressSink::RegisterProgressBar()
+{
+	std::shared_ptr<ProgressSlot> slot = std::make_shared<ProgressSlot>();
+
+	std::lock_guard<std::mutex> lk(SinkMutex);
+	Workers.push_back({ NextWorkerId++, slot });
+
+	return slot;
+}
+
+void ConsoleProgressSink::UnregisterProgressBar(const std::shared_ptr<ProgressSlot>& slot)
+{
+	std::lock_guard<std::mutex> lk(SinkMutex);
+
+	for (auto itr = Workers.begin(); itr != Workers.end(); itr++)
+	{
+		if (itr->Slot == slot)
+		{
+			Workers.erase(itr);
+			return;
+		}
+	}
+}
+
+void ConsoleProgressSink::StartEstimate()
+{
+	std::lock_guard<std::mutex> lk(SinkMutex);
+	Estimating = true;
+}
+
+void ConsoleProgressSink::Finish(const std::wstring& timeTaken)
+{
+	{
+		std::lock_guard<std::mutex> lk(SinkMutex);
+		Stopping = true;
+	}
+
+	StopSignal.notify_all();
+
+	if (ReportThread.joinable())
+	{
+		ReportThread.join();
+	}
+
+	Report();
+
+	/* time taken comes with a trailing new line for the install time file */
+	std::string timeTakenString = NosLib::String::ToString(timeTaken);
+	while (!timeTakenString.empty() && (timeTakenString.back() == '\n' || timeTakenString.back() == '\r'))
+	{
+		timeTakenString.pop_back();
+	}
+
+	if (OutputFormat == Format::Json)
+	{
+		Print(std::format("{{\"event\":\"finished\",\"time_taken\":\"{}\"}}", escapeJson(timeTakenString)));
+	}
+	else
+	{
+		Print(std::format("Finished | {}", timeTakenString));
+	}
+}
+
+void ConsoleProgressSink::ReportLoop()
+{
+	std::unique_lock<std::mutex> lk(SinkMutex);
+
+	while (!Stopping)
+	{
+		StopSignal.wait_for(lk, Interval, [this]() { return Stopping; });
+
+		if (Stopping)
+		{
+			break;
+		}
+
+		lk.unlock();
+		Report();
+		lk.lock();
+	}
+}
+
+void ConsoleProgressSink::Report()
+{
+	std::vector<std::string> lines;
+	bool estimating;
+
+	{
+		std::lock_guard<std::mutex> lk(SinkMutex);
+		estimating = Estimating;
+
+		/* only status changes get printed, progress of single workers would just be noise */
+		for (WorkerEntry& worker : Workers)
+		{
+			std::wstring status;
+			if (!worker.Slot->GetStatusIfChanged(&worker.SeenStatusVersion, &status))
+			{
+				continue;
+			}
+
+			if (OutputFormat == Format::Json)
+			{
+				lines.push_back(std::format("{{\"event\":\"status\",\"worker\":{},\"status\":\"{}\"}}", worker.Id, escapeJson(NosLib::String::ToString(status))));
+			}
+			else
+			{
+				lines.push_back(std::format("[worker {:2}] {}", worker.Id, NosLib::String::ToString(status)));
+			}
+		}
+	}
+
+	if (estimating)
+	{
+		InstallEstimator::Estimate estimate = InstallEstimator::Sample();
+
+		if (OutputFormat == Format::Json)
+		{
+			lines.push_back(std::format("{{\"event\":\"progress\",\"percentage\":{},\"seconds_left\":{:.0f},\"download_bytes_per_second\":{:.0f},\"extract_bytes_per_second\":{:.0f}}}",
+										estimate.Percentage,
+										estimate.SecondsLeft,
+										estimate.DownloadBytesPerSecond,
+										estimate.ExtractBytesPerSecond));
+		}
+		else
+		{
+			std::string timeLeft = "Estimating...";
+			if (estimate.SecondsLeft >= 0)
+			{
+				int minutesLeft = static_cast<int>(estimate.SecondsLeft / 60) + 1;
+				timeLeft = std::format("{}h {:02}m", minutesLeft / 60, minutesLeft % 60);
+			}
+
+			lines.push_back(std::format("[{:3}%] Time Left: {} | Download: {:.1f} MB/s | Extract: {:.1f} MB/s",
+										estimate.Percentage,
+										timeLeft,
+										estimate.DownloadBytesPerSecond / (1024 * 1024),
+										estimate.ExtractBytesPerSecond / (1024 * 1024)));
+		}
+	}
+
+	for (const std::string& line : lines)
+	{
+		Print(line);
+	}
+}
+
+void ConsoleProgressSink::Print(const std::string& line)
+{
+	std::cout << line << '\n';
+	std::cout.flush();
+}
@@ -0,0 +1,222 @@
+#include "../Headers/DownloadState.hpp"
+
+#include <NosLib/Logging.hpp>
+#include <NosLib/String.hpp>
+
+#include <fstream>
+#include <filesystem>
+#include <sstream>
+#include <format>
+
+void DownloadState::PlanSegments(const int& segmentCount)
+{
+	std::lock_guard<std::mutex> lk(StateMutex);
+
+	Segments.clear();
+
+	uint64_t segmentSize = ContentLength / segmentCount;
+	for (int i = 0; i < segmentCount; i++)
+	{
+		uint64_t segmentStart = segmentSize * i;
+		uint64_t segmentEnd = (i == segmentCount - 1 ? ContentLength : segmentStart + segmentSize) - 1;
+
+		Segments.push_back({ segmentStart, segmentEnd, 0 });
+	}
+}
+
+bool DownloadState::Matches(const std::wstring& url, const std::string& eTag, const std::string& lastModified, const uint64_t& contentLength)
+{
+	std::lock_guard<std::mutex> lk(StateMutex);
+
+	if (Url != url || ContentLength != contentLength || Segments.empty())
+	{
+		return false;
+	}
+
+	/* without a validator there is no way to tell if the file changed on the server */
+	if (!eTag.empty())
+	{
+		return ETag == eTag;
+	}
+
+	if (!lastModified.empty())
+	{
+		return LastModified == lastModified;
+	}
+
+	return false;
+}
+
+uint64_t DownloadState::GetCommittedBytes()
+{
+	std::lock_guard<std::mutex> lk(StateMutex);
+
+	uint64_t committedBytes = 0;
+	for (const Segment& segment : Segments)
+	{
+		committedBytes += segment.Committed;
+	}
+
+	return committedBytes;
+}
+
+void DownloadState::Commit(const size_t& segmentIndex, const uint64_t& committed, const std::wstring& statePath)
+{
+	{
+		std::lock_guard<std::mutex> lk(StateMutex);
+		Segments[segmentIndex].Committed = committed;
+	}
+
+	Save(statePath);
+}
+
+/* segments have to follow each other from the first byte to the last without gaps or overlaps, a missing piece would never get downloaded */
+static bool segmentsCoverContent(const std::vector<DownloadState::Segment>& segments, const uint64_t& contentLength)
+{
+	if (segments.empty() || contentLength == 0)
+	{
+		return false;
+	}
+
+	uint64_t nextStart = 0;
+	for (const DownloadState::Segment& segment : segments)
+	{
+		if (segment.Start != nextStart || segment.End < segment.Start || segment.End >= contentLength || segment.Committed > segment.End - segment.Start + 1)
+		{
+			return false;
+		}
+
+		nextStart = segment.End + 1;
+	}
+
+	return nextStart == contentLength;
+}
+
+bool DownloadState::Load(const std::wstring& statePath)
+{
+	std::lock_guard<std::mutex> lk(StateMutex);
+
+	std::ifstream stateFile(statePath, std::ios::binary);
+
+	if (!stateFile.is_open())
+	{
+		return false;
+	}
+
+	Segments.clear();
+
+	/* truncated or hand edited state, the download starts over */
+	auto invalidState = [&]()
+	{
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"Invalid download state \"{}\", starting over", statePath), NosLib::Logging::Severity::Warning);
+		Segments.clear();
+		return false;
+	};
+
+	std::string line;
+	while (std::getline(stateFile, line))
+	{
+		size_t separator = line.find('=');
+
+		if (separator == std::string::npos)
+		{
+			continue;
+		}
+
+		std::string key = line.substr(0, separator);
+		std::string value = line.substr(separator + 1);
+
+		if (key == "url")
+		{
+			Url = NosLib::String::ToWstring(value);
+		}
+		else if (key == "etag")
+		{
+			ETag = value;
+		}
+		else if (key == "lastmodified")
+		{
+			LastModified = value;
+		}
+		else if (key == "extension")
+		{
+			FileExtension = NosLib::String::ToWstring(value);
+		}
+		else if (key == "length")
+		{
+			try
+			{
+				ContentLength = std::stoull(value);
+			}
+			catch (const std::exception&)
+			{
+				return invalidState();
+			}
+		}
+		else if (key == "segment")
+		{
+			Segment segment;
+			std::istringstream segmentStream(value);
+			segmentStream >> segment.Start >> segment.End >> segment.Committed;
+
+			if (segmentStream.fail())
+			{
+				return invalidState();
+			}
+
+			Segments.push_back(segment);
+		}
+	}
+
+	if (!segmentsCoverContent(Segments, ContentLength))
+	{
+		return invalidState();
+	}
+
+	return true;
+}
+
+bool DownloadState::Save(const std::wstring& statePath)
+{
+	std::lock_guard<std::mutex> lk(StateMutex);
+
+	std::string stateContent = std::format("url={}\netag={}\nlastmodified={}\nextension={}\nlength={}\n",
+										   NosLib::String::ToString(Url),
+										   ETag,
+										   LastModified,
+										   NosLib::String::ToString(FileExtension),
+										   ContentLength);
+
+	for (const Segment& segment : Segments)
+	{
+		stateContent += std::format("segment={} {} {}\n", segment.Start, segment.End, segment.Committed);
+	}
+
+	/* write next to the state and swap, so a crash mid write doesn't leave a broken state behind */
+	std::wstring tempPath = statePath + L".tmp";
+	{
+		std::ofstream stateFile(tempPath, std::ios::binary | std::ios::trunc);
+		stateFile.write(stateContent.c_str(), stateContent.size());
+
+		if (!stateFile.good())
+		{
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tempPath, statePath, ec);
+	if (ec)
+	{
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"error: \"{}\" When trying to save download state", NosLib::String::ToWstring(ec.message())), NosLib::Logging::Severity::Error);
+		return false;
+	}
+
+	return true;
+}
+
+void DownloadState::Remove(const std::wstring& statePath)
+{
+	std::error_code ec;
+	std::filesystem::remove(statePath, ec);
+}
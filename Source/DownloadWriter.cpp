@@ -0,0 +1,201 @@
+#include "../Headers/DownloadWriter.hpp"
+
+#include <NosLib/Logging.hpp>
+#include <NosLib/String.hpp>
+
+#include <filesystem>
+#include <format>
+#include <cstring>
+
+#ifdef _WIN32
+#include <Windows.h>
+#elif defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif // _WIN32
+
+#ifdef _WIN32
+/* SetFileValidData needs the "manage volume" privilege, which only elevated processes can turn on */
+static bool enableManageVolumePrivilege()
+{
+	static const bool enabled = []()
+	{
+		HANDLE token;
+		if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+		{
+			return false;
+		}
+
+		TOKEN_PRIVILEGES privileges;
+		privileges.PrivilegeCount = 1;
+		privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+
+		/* AdjustTokenPrivileges succeeds even if the privilege wasn't assigned, only the last error tells */
+		bool adjusted = LookupPrivilegeValueW(nullptr, L"SeManageVolumePrivilege", &privileges.Privileges[0].Luid) &&
+						AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr) && GetLastError() == ERROR_SUCCESS;
+
+		CloseHandle(token);
+		return adjusted;
+	}();
+
+	return enabled;
+}
+#endif // _WIN32
+
+bool DownloadWriter::Preallocate(const std::wstring& path, const uint64_t& size)
+{
+	/* a crashed run can leave the old file behind as a hardlink to an archive cache object, truncating it would change the cached archive as well */
+	std::error_code ec;
+	std::filesystem::remove(std::filesystem::path(path), ec);
+
+	#ifdef _WIN32
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"error: {} When trying to create download File", GetLastError()), NosLib::Logging::Severity::Error);
+		return false;
+	}
+
+	/* reserves the clusters in 1 go, then sets the size without having to write any zeros */
+	FILE_ALLOCATION_INFO allocation;
+	allocation.AllocationSize.QuadPart = static_cast<LONGLONG>(size);
+	SetFileInformationByHandle(file, FileAllocationInfo, &allocation, sizeof(allocation));
+
+	FILE_END_OF_FILE_INFO endOfFile;
+	endOfFile.EndOfFile.QuadPart = static_cast<LONGLONG>(size);
+	bool allocated = SetFileInformationByHandle(file, FileEndOfFileInfo, &endOfFile, sizeof(endOfFile));
+
+	if (!allocated)
+	{
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"error: {} When trying to allocate download File", GetLastError()), NosLib::Logging::Severity::Error);
+	}
+
+	/* NTFS writes zeros from the end of the written data up to where a write starts, so the last segment would wait for zeros over most of the file.
+	 * Marking the whole size as written skips that, segments only trust what the download state says they committed */
+	if (allocated && size > 0 && enableManageVolumePrivilege() && !SetFileValidData(file, static_cast<LONGLONG>(size)))
+	{
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"error: {} When trying to skip zero filling the download File", GetLastError()), NosLib::Logging::Severity::Debug);
+	}
+
+	CloseHandle(file);
+	return allocated;
+	#else
+	{
+		std::ofstream createFile(std::filesystem::path(path), std::ios::binary | std::ios::trunc);
+		if (!createFile.is_open())
+		{
+			NosLib::Logging::CreateLog<wchar_t>(L"error: When trying to create download File", NosLib::Logging::Severity::Error);
+			return false;
+		}
+	}
+
+	if (size == 0)
+	{
+		return true;
+	}
+
+	#ifdef __linux__
+	/* actually reserves the blocks, resize_file would only make a sparse file */
+	int file = open(std::filesystem::path(path).c_str(), O_WRONLY);
+	if (file != -1)
+	{
+		bool allocated = (posix_fallocate(file, 0, static_cast<off_t>(size)) == 0);
+		close(file);
+
+		if (allocated)
+		{
+			return true;
+		}
+	}
+	#endif // __linux__
+
+	std::filesystem::resize_file(std::filesystem::path(path), size, ec);
+	if (ec)
+	{
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"error: \"{}\" When trying to allocate download File", NosLib::String::ToWstring(ec.message())), NosLib::Logging::Severity::Error);
+		return false;
+	}
+	return true;
+	#endif // _WIN32
+}
+
+bool DownloadWriter::Open(const std::wstring& path, const uint64_t& offset)
+{
+	Close();
+
+	Stream.open(std::filesystem::path(path), std::ios::binary | std::ios::in | std::ios::out);
+	Stream.seekp(offset);
+
+	Buffer.resize(ReserveBuffer());
+	Buffered = 0;
+	Written = 0;
+
+	return Stream.good();
+}
+
+bool DownloadWriter::Write(const char* data, const size_t& length)
+{
+	Written += length;
+
+	/* wouldn't fit, empty the buffer first */
+	if (Buffered + length > Buffer.size() && !Flush())
+	{
+		return false;
+	}
+
+	/* bigger than the whole buffer, nothing gained by copying it */
+	if (length >= Buffer.size())
+	{
+		Stream.write(data, length);
+		return Stream.good();
+	}
+
+	std::memcpy(Buffer.data() + Buffered, data, length);
+	Buffered += length;
+	return true;
+}
+
+bool DownloadWriter::Flush()
+{
+	if (Buffered > 0)
+	{
+		Stream.write(Buffer.data(), Buffered);
+		Buffered = 0;
+	}
+
+	Stream.flush();
+	return Stream.good();
+}
+
+bool DownloadWriter::Close()
+{
+	bool closed = true;
+	if (Stream.is_open())
+	{
+		closed = Flush();
+		Stream.close();
+		closed &= !Stream.fail();
+	}
+
+	/* the buffer can be 4MB, don't keep it around for however long the writer lives. Also given back if opening failed */
+	TotalBuffered -= Buffer.size();
+	Buffer.clear();
+	Buffer.shrink_to_fit();
+	return closed;
+}
+
+size_t DownloadWriter::ReserveBuffer()
+{
+	uint64_t current = TotalBuffered.load();
+	size_t size;
+
+	do
+	{
+		uint64_t available = (current < TotalBufferLimit ? TotalBufferLimit - current : 0);
+		size = (available < BufferSize ? static_cast<size_t>(available) : BufferSize);
+		size = (size < MinBufferSize ? MinBufferSize : size);
+	}
+	while (!TotalBuffered.compare_exchange_weak(current, current + size));
+
+	return size;
+}
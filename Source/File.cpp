@@ -1,14 +1,185 @@
 #include "../Headers/File.hpp"
 #include "../Headers/ModInfo.hpp"
 #include "../Headers/Github.hpp"
+#include "../Headers/DownloadState.hpp"
+#include "../Headers/InstallManifest.hpp"
+#include "../Headers/Hash.hpp"
+#include "../Headers/ConnectionPool.hpp"
+#include "../Headers/BandwidthLimiter.hpp"
+#include "../Headers/InstallEstimator.hpp"
+#include "../Headers/DownloadWriter.hpp"
 
 #include <NosLib/HttpClient.hpp>
 
 #include <fstream>
 #include <filesystem>
+#include <future>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cwctype>
 
 NosLib::HashTable<std::wstring, File*> File::fileHastTable(&File::GetKey, 400);
 
+/* splits "https://host.com/some/path" into "https://host.com" and "/some/path" */
+static void splitLocation(const std::string& location, std::string* hostUrl, std::string* path)
+{
+	size_t schemeEnd = location.find("://");
+	size_t pathStart = location.find('/', (schemeEnd == std::string::npos ? 0 : schemeEnd + 3));
+
+	if (pathStart == std::string::npos)
+	{
+		*hostUrl = location;
+		*path = "/";
+		return;
+	}
+
+	*hostUrl = location.substr(0, pathStart);
+	*path = location.substr(pathStart);
+}
+
+/* backslash separated and without separators on either end */
+static std::wstring trimArchivePath(std::wstring path)
+{
+	for (wchar_t& character : path)
+	{
+		if (character == L'/')
+		{
+			character = L'\\';
+		}
+	}
+
+	size_t start = path.find_first_not_of(L'\\');
+	if (start == std::wstring::npos)
+	{
+		return L"";
+	}
+
+	return path.substr(start, path.find_last_not_of(L'\\') - start + 1);
+}
+
+/* trimmed and lowercase, archive paths get compared the same way windows compares them */
+static std::wstring normalizeArchivePath(const std::wstring& path)
+{
+	std::wstring normalizedPath = trimArchivePath(path);
+	for (wchar_t& character : normalizedPath)
+	{
+		character = (wchar_t)std::towlower(character);
+	}
+
+	return normalizedPath;
+}
+
+/* checks a normalized item path against a normalized prefix. relativeStart gets set to where the part of the path which goes under the prefix's destination starts */
+static bool matchArchivePath(const std::wstring& prefix, const bool& recursive, const std::wstring& itemPath, size_t* relativeStart)
+{
+	if (prefix.empty())
+	{
+		*relativeStart = 0;
+	}
+	else if (itemPath == prefix) /* the path itself (a single file, or the directory) */
+	{
+		size_t lastSeparator = itemPath.rfind(L'\\');
+		*relativeStart = (lastSeparator == std::wstring::npos ? 0 : lastSeparator + 1);
+		return true;
+	}
+	else if (itemPath.size() > prefix.size() && itemPath.compare(0, prefix.size(), prefix) == 0 && itemPath[prefix.size()] == L'\\')
+	{
+		*relativeStart = prefix.size() + 1;
+	}
+	else
+	{
+		return false;
+	}
+
+	return recursive || itemPath.find(L'\\', *relativeStart) == std::wstring::npos;
+}
+
+/* a relative archive path going under destination. Rooted paths and ".." segments could write outside of it, those get rejected */
+static bool isContainedPath(const std::filesystem::path& destination, const std::wstring& relativePath)
+{
+	if (relativePath.empty() || std::filesystem::path(relativePath).has_root_path())
+	{
+		return false;
+	}
+
+	size_t segmentStart = 0;
+	while (segmentStart <= relativePath.size())
+	{
+		size_t segmentEnd = relativePath.find(L'\\', segmentStart);
+		if (segmentEnd == std::wstring::npos)
+		{
+			segmentEnd = relativePath.size();
+		}
+
+		if (relativePath.compare(segmentStart, segmentEnd - segmentStart, L"..") == 0)
+		{
+			return false;
+		}
+
+		segmentStart = segmentEnd + 1;
+	}
+
+	std::filesystem::path normalDestination = destination.lexically_normal();
+	std::filesystem::path relative = (normalDestination / relativePath).lexically_normal().lexically_relative(normalDestination);
+	return !relative.empty() && relative.begin()->wstring() != L"..";
+}
+
+static void logExtractException(const bit7z::BitException& ex)
+{
+	std::wstring errorMessage;
+	for (std::pair<std::wstring, std::error_code> entry : ex.failedFiles())
+	{
+		errorMessage += std::format(L"{} : {}\n", entry.first, NosLib::String::ToWstring(entry.second.message()));
+	}
+
+	errorMessage += NosLib::String::ToWstring(std::format("{}\n", ex.what()));
+	NosLib::Logging::CreateLog<wchar_t>(errorMessage, NosLib::Logging::Severity::Error);
+}
+
+bool File::ExtractRule::Matches(const std::wstring& itemPath) const
+{
+	size_t relativeStart;
+	return matchArchivePath(Prefix, Recursive, itemPath, &relativeStart);
+}
+
+void File::AddExtractPath(const std::wstring& insidePath, const bool& recursive)
+{
+	ExtractRules.push_back({ normalizeArchivePath(insidePath), recursive });
+
+	/* already extracted for the earlier users, this user's paths still need extracting. Only happens while setting up, before the pipeline runs.
+	 * direct installs never extracted anything, every user reads straight from the archive */
+	if (Extracted.load() && !DirectInstall.load())
+	{
+		Extracted = false;
+		Claimed = false;
+
+		/* in memory downloads get freed after extracting */
+		if (!std::filesystem::exists(GetDownloadPath()))
+		{
+			Downloaded = false;
+		}
+	}
+}
+
+bool File::WantsItem(const std::wstring& itemPath)
+{
+	if (ExtractRules.empty())
+	{
+		return true;
+	}
+
+	for (const ExtractRule& rule : ExtractRules)
+	{
+		if (rule.Matches(itemPath))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
 
 std::wstring File::GetFileExtensionFromHeader(const std::string& type)
 {
@@ -50,30 +221,27 @@ File::HostType File::DetermineHostType(const std::wstring& hostName)
 	return HostType::Unknown;
 }
 
-bool File::DownloadFile()
+bool File::OpenDownloadClient(ConnectionPool::Lease* downloadClient, std::string* downloadHost, std::wstring* downloadLink)
 {
-	/* create directories in order to prevent any errors */
-	std::filesystem::create_directories(DownloadDirectory);
-
-	NosLib::HttpClient::ptr downloadClient = nullptr;
-	std::wstring downloadLink;
-
 	/* Decide the host type, there are different download steps for different websites */
 	switch (DetermineHostType(Link.Host))
 	{
 	case HostType::ModDB:
-		downloadClient = ModDB::CreateDownloadClient();
-		downloadLink = ModDB::GetDownloadString(Link.Path);
+		*downloadClient = ModDB::CreateDownloadClient();
+		*downloadHost = ModDB::HostUrl;
+		*downloadLink = ModDB::GetDownloadString(Link.Path);
 		break;
 
 	case HostType::GithubObjects:
-		downloadClient = Github::CreateDownloadObjectsClient();
-		downloadLink = Link.Path;
+		*downloadClient = Github::CreateDownloadObjectsClient();
+		*downloadHost = Github::ObjectsHostUrl;
+		*downloadLink = Link.Path;
 		break;
 
 	case HostType::Github:
-		downloadClient = Github::CreateDownloadClient();
-		downloadLink = Link.Path;
+		*downloadClient = Github::CreateDownloadClient();
+		*downloadHost = Github::HostUrl;
+		*downloadLink = Link.Path;
 		break;
 
 	default:
@@ -81,32 +249,248 @@ bool File::DownloadFile()
 		return false;
 	}
 
-	if (downloadClient == nullptr)
+	if (downloadClient->get() == nullptr)
 	{
 		NosLib::Logging::CreateLog<wchar_t>(std::format(L"Unable to get Download Client for Mod: \"{}\"", Link.Full()), NosLib::Logging::Severity::Error);
 		return false;
 	}
 
-	if (downloadLink.empty())
+	if (downloadLink->empty())
 	{
 		NosLib::Logging::CreateLog<wchar_t>(std::format(L"Unable to get Download Link for Mod: \"{}\"", Link.Full()), NosLib::Logging::Severity::Error);
 		return false;
 	}
 
-	return GetAndSaveFile(downloadClient.get(), downloadLink, DownloadDirectory);
+	return true;
+}
+
+bool File::DownloadFile()
+{
+	/* create directories in order to prevent any errors */
+	std::filesystem::create_directories(DownloadDirectory);
+
+	/* ModDB links point at a single upload which never changes, so a cached copy gets used without asking ModDB at all.
+	 * other hosts get checked against the server first (in GetAndSaveFile) */
+	ArchiveCache::Entry cachedEntry;
+	if (ArchiveCache::IsEnabled() && DetermineHostType(Link.Host) == HostType::ModDB && ArchiveCache::Find(Link.Full(), &cachedEntry) && RestoreFromCache(cachedEntry))
+	{
+		return true;
+	}
+
+	ConnectionPool::Lease downloadClient;
+	std::string downloadHost;
+	std::wstring downloadLink;
+
+	if (!OpenDownloadClient(&downloadClient, &downloadHost, &downloadLink))
+	{
+		return false;
+	}
+
+	/* partial downloads are kept between attempts, so a retry continues where the last one stopped */
+	for (int attempt = 1; attempt <= DownloadAttempts; attempt++)
+	{
+		if (GetAndSaveFile(downloadClient.get(), downloadHost, downloadLink))
+		{
+			return true;
+		}
+
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"Download attempt {} of {} failed for \"{}\"", attempt, DownloadAttempts, Link.Full()), NosLib::Logging::Severity::Warning);
+	}
+
+	return false;
 }
 
-bool File::GetAndSaveFile(httplib::Client* client, const std::wstring& urlFilePath, const std::wstring& pathOffsets)
+bool File::CheckIfUnchanged(const Version& version)
 {
-	std::ofstream downloadFile;
+	if (!version.IsKnown())
+	{
+		return false;
+	}
 
+	ConnectionPool::Lease checkClient;
+	std::string checkHost;
+	std::wstring checkLink;
+
+	if (!OpenDownloadClient(&checkClient, &checkHost, &checkLink))
+	{
+		return false;
+	}
+
+	/* the same conditional request the archive cache uses, only a "304 Not Modified" counts */
+	ArchiveCache::Entry versionEntry;
+	versionEntry.ETag = version.ETag;
+	versionEntry.LastModified = version.LastModified;
+
+	RemoteFileInfo remoteInfo;
+	return ProbeRemoteFile(checkClient.get(), checkHost, NosLib::String::ToString(checkLink), &remoteInfo, &versionEntry) && remoteInfo.NotModified;
+}
+
+bool File::GetAndSaveFile(httplib::Client* client, const std::string& hostUrl, const std::wstring& urlFilePath)
+{
 	SetThreadExecutionState(ES_CONTINUOUS | ES_SYSTEM_REQUIRED);
-	httplib::Result res = client->Get(NosLib::String::ToString(urlFilePath),
+
+	std::string urlPath = NosLib::String::ToString(urlFilePath);
+
+	/* small archives stay in memory and get extracted from there, servers which support ranges get resumable (and for big files, segmented) downloads, everything else uses a single stream */
+	ArchiveCache::Entry cachedEntry;
+	bool cached = ArchiveCache::IsEnabled() && ArchiveCache::Find(Link.Full(), &cachedEntry);
+
+	RemoteFileInfo remoteInfo;
+	bool probed = ProbeRemoteFile(client, hostUrl, urlPath, &remoteInfo, (cached ? &cachedEntry : nullptr));
+
+	/* same version as the server has is already cached, either the server said so (304) or the validators match */
+	if (cached && probed &&
+		(remoteInfo.NotModified || cachedEntry.Matches(remoteInfo.ETag, remoteInfo.LastModified, remoteInfo.ContentLength)) && RestoreFromCache(cachedEntry))
+	{
+		return true;
+	}
+
+	bool downloaded;
+	if (probed && remoteInfo.AcceptsRanges)
+	{
+		downloaded = (remoteInfo.ContentLength < InMemoryDownloadThreshold && ReserveMemory(remoteInfo.ContentLength) ? MemoryDownload(remoteInfo) : RangedDownload(remoteInfo));
+	}
+	else
+	{
+		/* without a probe nothing is known about where the redirects end, bandwidth gets counted against the link host */
+		if (remoteInfo.HostUrl.empty())
+		{
+			remoteInfo.HostUrl = hostUrl;
+		}
+
+		downloaded = SingleStreamDownload(client, urlPath, &remoteInfo);
+	}
+
+	if (downloaded)
+	{
+		DownloadedVersion = { remoteInfo.ETag, remoteInfo.LastModified };
+		StoreInCache(remoteInfo);
+	}
+
+	return downloaded;
+}
+
+bool File::ProbeRemoteFile(httplib::Client* client, const std::string& hostUrl, const std::string& urlFilePath, RemoteFileInfo* remoteInfo, const ArchiveCache::Entry* cachedEntry)
+{
+	/* Ask for the first byte only, a "206 Partial Content" response proves that ranges work and "Content-Range" gives the full size.
+	 * GET is used instead of HEAD since signed download links (github objects, mirrors) usually only allow GET */
+	httplib::Headers probeHeaders = { {"Range", "bytes=0-0"} };
+
+	/* with a cached copy, the server can answer "304 Not Modified" instead. Github branch archives don't support ranges, so this is the only check they get */
+	if (cachedEntry != nullptr)
+	{
+		if (!cachedEntry->ETag.empty())
+		{
+			probeHeaders.emplace("If-None-Match", cachedEntry->ETag);
+		}
+
+		if (!cachedEntry->LastModified.empty())
+		{
+			probeHeaders.emplace("If-Modified-Since", cachedEntry->LastModified);
+		}
+	}
+
+	httplib::Result res = client->Get(urlFilePath, probeHeaders,
+									  [&](const httplib::Response& response)
+	{
+		/* server ignored the range and is about to send the entire file, cancel it */
+		return response.status == 206 || response.status == 304;
+	},
+									  [&](const char* data, size_t data_length)
+	{
+		return true;
+	});
+
+	if (res && res->status == 304)
+	{
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"\"{}\" hasn't changed", Link.Full()), NosLib::Logging::Severity::Info);
+		remoteInfo->NotModified = true;
+		return true;
+	}
+
+	if (!res || res->status != 206)
+	{
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"\"{}\" doesn't support ranged requests, using a single stream", Link.Full()), NosLib::Logging::Severity::Debug);
+		return false;
+	}
+
+	/* "Content-Range: bytes 0-0/12345" */
+	std::string contentRange = res->get_header_value("Content-Range");
+	size_t sizeStart = contentRange.find('/');
+
+	if (sizeStart == std::string::npos || contentRange.substr(sizeStart + 1) == "*")
+	{
+		return false;
+	}
+
+	try
+	{
+		remoteInfo->ContentLength = std::stoull(contentRange.substr(sizeStart + 1));
+	}
+	catch (const std::exception&)
+	{
+		return false;
+	}
+
+	remoteInfo->ContentType = res->get_header_value("Content-Type");
+	remoteInfo->ETag = res->get_header_value("ETag");
+	remoteInfo->LastModified = res->get_header_value("Last-Modified");
+	remoteInfo->AcceptsRanges = true;
+	CountDownloadSize(remoteInfo->ContentLength);
+
+	/* segments connect straight to where the redirects ended, instead of redirecting once per segment */
+	if (res->location.empty())
+	{
+		remoteInfo->HostUrl = hostUrl;
+		remoteInfo->Path = urlFilePath;
+	}
+	else
+	{
+		splitLocation(res->location, &remoteInfo->HostUrl, &remoteInfo->Path);
+	}
+
+	return true;
+}
+
+bool File::SingleStreamDownload(httplib::Client* client, const std::string& urlFilePath, RemoteFileInfo* remoteInfo)
+{
+	DownloadWriter downloadFile;
+	uint64_t expectedLength = 0; /* 0 if the server didn't say */
+
+	httplib::Result res = client->Get(urlFilePath,
 									  [&](const httplib::Response& response)
 	{
 		if (FileName.FileExtension.empty())
 		{
-			FileName.FileExtension = GetFileExtensionFromHeader(response.headers.find("Content-Type")->second);
+			FileName.FileExtension = GetFileExtensionFromHeader(response.get_header_value("Content-Type"));
+		}
+
+		/* validators for the archive cache, so the next run can ask if it changed */
+		remoteInfo->ETag = response.get_header_value("ETag");
+		remoteInfo->LastModified = response.get_header_value("Last-Modified");
+
+		if (response.has_header("Content-Length"))
+		{
+			/* unreadable length is the same as none, the download just can't be checked */
+			try
+			{
+				expectedLength = std::stoull(response.get_header_value("Content-Length"));
+			}
+			catch (const std::exception&)
+			{
+				expectedLength = 0;
+			}
+
+			if (expectedLength != 0)
+			{
+				CountDownloadSize(expectedLength);
+			}
+		}
+
+		/* encoded bodies get decoded as they come in, the length is the one before decoding */
+		if (response.has_header("Content-Encoding") && response.get_header_value("Content-Encoding") != "identity")
+		{
+			expectedLength = 0;
 		}
 
 		std::wstring statusText = std::format(L"Downloading \"{}\"", FileName.GetFullFileName());
@@ -119,15 +503,14 @@ bool File::GetAndSaveFile(httplib::Client* client, const std::wstring& urlFilePa
 
 		(CallerPointer->*StatusCallback)(statusText);
 
-		/* before start download, get "Content-Type" header tag to see the extensions, then open with the name+extension */
-		downloadFile.open(pathOffsets + FileName.GetFullFileName(), std::ios::binary | std::ios::trunc);
-		return true;
+		/* can't be continued without ranges, so any old partial download gets thrown away */
+		return DownloadWriter::Preallocate(GetPartPath(), expectedLength) && downloadFile.Open(GetPartPath(), 0);
 	},
 									  [&](const char* data, size_t data_length)
 	{
 		/* write to file while downloading, this makes sure that it doesn't download to memory and then write */
-		downloadFile.write(data, data_length);
-		return true;
+		CountDownloaded(remoteInfo->HostUrl, data_length);
+		return downloadFile.Write(data, data_length);
 	},
 									  [&](uint64_t len, uint64_t total)
 	{
@@ -146,7 +529,484 @@ bool File::GetAndSaveFile(httplib::Client* client, const std::wstring& urlFilePa
 		return false;
 	}
 
-	downloadFile.close();
+	if (!downloadFile.Close())
+	{
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"Failed to write \"{}\" to the disk", GetPartPath()), NosLib::Logging::Severity::Error);
+		return false;
+	}
+
+	/* a cut off download would otherwise only show up once bit7z fails to read the archive */
+	if (expectedLength != 0 && downloadFile.GetWritten() != expectedLength)
+	{
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"Download of \"{}\" was cut off, got {} of {} bytes", Link.Full(), downloadFile.GetWritten(), expectedLength), NosLib::Logging::Severity::Error);
+		return false;
+	}
+
+	DownloadState::Remove(GetStatePath());
+	return FinalizePartFile();
+}
+
+bool File::RangedDownload(const RemoteFileInfo& remoteInfo)
+{
+	std::wstring partPath = GetPartPath();
+	std::wstring statePath = GetStatePath();
+
+	DownloadState state;
+	bool resuming = state.Load(statePath) &&
+					state.Matches(Link.Full(), remoteInfo.ETag, remoteInfo.LastModified, remoteInfo.ContentLength) &&
+					std::filesystem::exists(partPath);
+
+	if (FileName.FileExtension.empty())
+	{
+		FileName.FileExtension = (resuming ? state.FileExtension : GetFileExtensionFromHeader(remoteInfo.ContentType));
+	}
+
+	if (!resuming)
+	{
+		state.Url = Link.Full();
+		state.ETag = remoteInfo.ETag;
+		state.LastModified = remoteInfo.LastModified;
+		state.FileExtension = FileName.FileExtension;
+		state.ContentLength = remoteInfo.ContentLength;
+		state.PlanSegments(remoteInfo.ContentLength >= SegmentedDownloadThreshold ? DownloadSegmentCount : 1);
+
+		/* create the file at full size, so every segment can write straight into its own part of it */
+		if (!DownloadWriter::Preallocate(partPath, remoteInfo.ContentLength))
+		{
+			return false;
+		}
+
+		state.Save(statePath);
+	}
+
+	std::atomic<uint64_t> downloadedBytes = state.GetCommittedBytes();
+
+	std::wstring statusText = std::format(L"Downloading \"{}\"", FileName.GetFullFileName());
+	if (state.Segments.size() > 1)
+	{
+		statusText += std::format(L" - {} Segments", state.Segments.size());
+	}
+	if (resuming)
+	{
+		statusText += std::format(L" - Resuming at {}MB", downloadedBytes.load() / (1024 * 1024));
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"Resuming \"{}\" with {} bytes already downloaded", FileName.GetFullFileName(), downloadedBytes.load()), NosLib::Logging::Severity::Info);
+	}
+	(CallerPointer->*StatusCallback)(statusText);
+
+	auto downloadSegment = [&](size_t segmentIndex)
+	{
+		const DownloadState::Segment& segment = state.Segments[segmentIndex];
+
+		if (segment.IsComplete())
+		{
+			return true;
+		}
+
+		ConnectionPool::Lease segmentClient = ConnectionPool::Acquire(remoteInfo.HostUrl);
+
+		DownloadWriter segmentFile;
+		if (!segmentFile.Open(partPath, segment.GetResumeOffset()))
+		{
+			return false;
+		}
+
+		uint64_t committed = segment.Committed;
+		uint64_t uncommitted = 0;
+
+		httplib::Headers rangeHeader = { {"Range", std::format("bytes={}-{}", segment.GetResumeOffset(), segment.End)} };
+
+		httplib::Result res = segmentClient->Get(remoteInfo.Path, rangeHeader,
+												 [&](const httplib::Response& response)
+		{
+			return response.status == 206;
+		},
+												 [&](const char* data, size_t data_length)
+		{
+			if (!segmentFile.Write(data, data_length))
+			{
+				return false;
+			}
+
+			uncommitted += data_length;
+			CountDownloaded(remoteInfo.HostUrl, data_length);
+
+			/* only count bytes as downloaded once they are flushed, anything after the last commit gets downloaded again after a crash */
+			if (uncommitted >= CommitInterval)
+			{
+				if (!segmentFile.Flush())
+				{
+					return false;
+				}
+
+				committed += uncommitted;
+				uncommitted = 0;
+				state.Commit(segmentIndex, committed, statePath);
+			}
+
+			return (CallerPointer->*ProgressCallback)(downloadedBytes += data_length, remoteInfo.ContentLength);
+		});
+
+		bool written = segmentFile.Close();
+		if (written)
+		{
+			state.Commit(segmentIndex, committed + uncommitted, statePath);
+		}
+
+		if (!res)
+		{
+			NosLib::Logging::CreateLog<wchar_t>(std::format(L"connection error code: {}", NosLib::String::ToWstring(httplib::to_string(res.error()))), NosLib::Logging::Severity::Error);
+			return false;
+		}
+
+		if (res->status != 206)
+		{
+			NosLib::Logging::CreateLog<char>(std::format("Segment {}-{} failed. Status: {} | Reason: \"{}\"", segment.Start, segment.End, res->status, res->reason), NosLib::Logging::Severity::Error);
+			return false;
+		}
+
+		if (!written)
+		{
+			NosLib::Logging::CreateLog<wchar_t>(std::format(L"Failed to write \"{}\" to the disk", partPath), NosLib::Logging::Severity::Error);
+			return false;
+		}
+
+		/* server can end a range early, the segment then gets continued on the next attempt */
+		if (segment.Start + committed + uncommitted != segment.End + 1)
+		{
+			NosLib::Logging::CreateLog<char>(std::format("Segment {}-{} was cut off after {} bytes", segment.Start, segment.End, committed + uncommitted), NosLib::Logging::Severity::Error);
+			return false;
+		}
+
+		return true;
+	};
+
+	std::vector<std::future<bool>> futures;
+	for (size_t i = 0; i < state.Segments.size(); i++)
+	{
+		futures.emplace_back(std::async(std::launch::async, downloadSegment, i));
+	}
+
+	bool allSucceeded = true;
+	for (std::future<bool>& future : futures)
+	{
+		allSucceeded &= future.get();
+	}
+
+	if (!allSucceeded)
+	{
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"Download of \"{}\" failed, keeping {} bytes for the next attempt", Link.Full(), state.GetCommittedBytes()), NosLib::Logging::Severity::Error);
+		return false;
+	}
+
+	DownloadState::Remove(statePath);
+	return FinalizePartFile();
+}
+
+bool File::MemoryDownload(const RemoteFileInfo& remoteInfo)
+{
+	if (FileName.FileExtension.empty())
+	{
+		FileName.FileExtension = GetFileExtensionFromHeader(remoteInfo.ContentType);
+	}
+
+	(CallerPointer->*StatusCallback)(std::format(L"Downloading \"{}\"", FileName.GetFullFileName()));
+
+	ConnectionPool::Lease memoryClient = ConnectionPool::Acquire(remoteInfo.HostUrl);
+
+	ArchiveBuffer.clear();
+	ArchiveBuffer.reserve(remoteInfo.ContentLength);
+
+	httplib::Result res = memoryClient->Get(remoteInfo.Path,
+											[&](const httplib::Response& response)
+	{
+		return response.status == 200;
+	},
+											[&](const char* data, size_t data_length)
+	{
+		ArchiveBuffer.insert(ArchiveBuffer.end(), reinterpret_cast<const bit7z::byte_t*>(data), reinterpret_cast<const bit7z::byte_t*>(data) + data_length);
+		CountDownloaded(remoteInfo.HostUrl, data_length);
+		return (CallerPointer->*ProgressCallback)(ArchiveBuffer.size(), remoteInfo.ContentLength);
+	});
+
+	if (!res)
+	{
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"connection error code: {}", NosLib::String::ToWstring(httplib::to_string(res.error()))), NosLib::Logging::Severity::Error);
+		FreeArchiveBuffer();
+		return false;
+	}
+
+	if (res->status != 200)
+	{
+		NosLib::Logging::CreateLog<char>(std::format("File not found. Status: {} | Reason: \"{}\"", res->status, res->reason), NosLib::Logging::Severity::Error);
+		FreeArchiveBuffer();
+		return false;
+	}
+
+	/* a connection dropped early would otherwise go into the cache and only fail once bit7z reads it */
+	if (ArchiveBuffer.size() != remoteInfo.ContentLength)
+	{
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"Download of \"{}\" was cut off, got {} of {} bytes", Link.Full(), ArchiveBuffer.size(), remoteInfo.ContentLength), NosLib::Logging::Severity::Error);
+		FreeArchiveBuffer();
+		return false;
+	}
+
+	InMemory = true;
+	NosLib::Logging::CreateLog<wchar_t>(std::format(L"Downloaded \"{}\" into memory ({} bytes)", FileName.GetFullFileName(), ArchiveBuffer.size()), NosLib::Logging::Severity::Info);
+	return true;
+}
+
+bool File::ReserveMemory(const uint64_t& size)
+{
+	uint64_t current = InMemoryBytes.load();
+
+	do
+	{
+		if (current + size > InMemoryTotalLimit)
+		{
+			NosLib::Logging::CreateLog<wchar_t>(std::format(L"Too many archives in memory, downloading \"{}\" to the disk", Link.Full()), NosLib::Logging::Severity::Debug);
+			return false;
+		}
+	}
+	while (!InMemoryBytes.compare_exchange_weak(current, current + size));
+
+	MemoryReserved = size;
+	return true;
+}
+
+void File::FreeArchiveBuffer()
+{
+	ArchiveBuffer.clear();
+	ArchiveBuffer.shrink_to_fit();
+	InMemory = false;
+
+	InMemoryBytes -= MemoryReserved;
+	MemoryReserved = 0;
+}
+
+bool File::FinalizePartFile()
+{
+	std::error_code ec;
+	std::filesystem::rename(GetPartPath(), GetDownloadPath(), ec);
+	if (ec)
+	{
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"error: \"{}\" When trying to finalize download File", NosLib::String::ToWstring(ec.message())), NosLib::Logging::Severity::Error);
+		return false;
+	}
+
+	NosLib::Logging::CreateLog<wchar_t>(std::format(L"Downloaded \"{}\"", GetDownloadPath()), NosLib::Logging::Severity::Info);
+	return true;
+}
+
+bool File::RestoreFromCache(const ArchiveCache::Entry& entry)
+{
+	if (FileName.FileExtension.empty())
+	{
+		FileName.FileExtension = entry.FileExtension;
+	}
+
+	(CallerPointer->*StatusCallback)(std::format(L"Using cached \"{}\"", FileName.GetFullFileName()));
+	CountDownloadSize(entry.ContentLength);
+	DownloadedVersion = { entry.ETag, entry.LastModified };
+	return ArchiveCache::Restore(entry, GetDownloadPath());
+}
+
+void File::CountDownloadSize(const uint64_t& size)
+{
+	if (DownloadSizeCounted)
+	{
+		return;
+	}
+
+	DownloadSizeCounted = true;
+	CountedDownloadSize = size;
+	InstallEstimator::AddDownloadSize(size);
+}
+
+void File::CountDownloaded(const std::string& hostUrl, const uint64_t& bytes)
+{
+	BandwidthLimiter::Consume(hostUrl, bytes);
+
+	CountedDownloadBytes += bytes;
+	InstallEstimator::AddDownloaded(bytes);
+}
+
+void File::FinishDownloadEstimate()
+{
+	/* size was never announced (chunked) or the file came from somewhere without downloading (cache, earlier run), either way it's done now */
+	CountDownloadSize(CountedDownloadBytes.load());
+
+	if (CountedDownloadSize > CountedDownloadBytes)
+	{
+		InstallEstimator::AddDownloaded(CountedDownloadSize - CountedDownloadBytes);
+		CountedDownloadBytes = CountedDownloadSize;
+	}
+}
+
+void File::StoreInCache(const RemoteFileInfo& remoteInfo)
+{
+	if (!ArchiveCache::IsEnabled())
+	{
+		return;
+	}
+
+	ArchiveCache::Entry entry;
+	entry.Url = Link.Full();
+	entry.ETag = remoteInfo.ETag;
+	entry.LastModified = remoteInfo.LastModified;
+	entry.ContentLength = remoteInfo.ContentLength;
+	entry.FileExtension = FileName.FileExtension;
+
+	if (InMemory)
+	{
+		entry.ContentLength = ArchiveBuffer.size();
+		ArchiveCache::Store(entry, ArchiveBuffer);
+		return;
+	}
+
+	std::error_code ec;
+	entry.ContentLength = std::filesystem::file_size(GetDownloadPath(), ec);
+	ArchiveCache::Store(entry, GetDownloadPath());
+}
+
+std::unique_ptr<bit7z::BitArchiveReader> File::OpenArchive()
+{
+	if (InMemory)
+	{
+		return std::make_unique<bit7z::BitArchiveReader>(lib, ArchiveBuffer);
+	}
+
+	return std::make_unique<bit7z::BitArchiveReader>(lib, GetDownloadPath());
+}
+
+bool File::InstallDirect(ModInfo* callerPointer, const Progress& progressCallback, const std::vector<ExtractTarget>& targets, const std::wstring& owner)
+{
+	struct ItemWrite
+	{
+		uint32_t Index;
+		uint64_t Size;
+		std::wstring Destination;
+	};
+
+	std::vector<ExtractRule> rules;
+	for (const ExtractTarget& target : targets)
+	{
+		rules.push_back({ normalizeArchivePath(target.InsidePath), target.Recursive });
+	}
+
+	try
+	{
+		/* each user has its own reader, the archive (or buffer) only gets read */
+		std::unique_ptr<bit7z::BitArchiveReader> reader = OpenArchive();
+
+		/* work out where every item goes first, so progress has a total */
+		std::vector<ItemWrite> items;
+		std::vector<std::wstring> itemPaths;
+		std::vector<std::wstring> normalizedPaths;
+		for (const bit7z::BitArchiveItem& item : reader->items())
+		{
+			if (item.isDir())
+			{
+				continue;
+			}
+
+			items.push_back({ item.index(), item.size(), L"" });
+			itemPaths.push_back(trimArchivePath(item.path()));
+			normalizedPaths.push_back(normalizeArchivePath(itemPaths.back()));
+		}
+
+		/* targets get applied in order, the same as copying the inner paths one after another. An item which more than one target writes to the same place
+		 * (a main folder and an optional variant of it) comes from the last of them */
+		std::vector<ItemWrite> writes;
+		std::unordered_map<std::wstring, size_t> writeIndexes; /* normalized destination -> index into writes */
+		for (size_t i = 0; i < rules.size(); i++)
+		{
+			for (size_t j = 0; j < items.size(); j++)
+			{
+				size_t relativeStart;
+				if (!matchArchivePath(rules[i].Prefix, rules[i].Recursive, normalizedPaths[j], &relativeStart))
+				{
+					continue;
+				}
+
+				std::wstring relativePath = itemPaths[j].substr(relativeStart);
+
+				/* bit7z cleans up item paths when extracting to a directory, writing them by hand has to check them instead */
+				if (!isContainedPath(targets[i].Destination, relativePath))
+				{
+					NosLib::Logging::CreateLog<wchar_t>(std::format(L"\"{}\" in \"{}\" would be written outside of \"{}\", not installing it", itemPaths[j], FileName.GetFullFileName(), targets[i].Destination), NosLib::Logging::Severity::Error);
+					return false;
+				}
+
+				ItemWrite write = items[j];
+				write.Destination = (std::filesystem::path(targets[i].Destination) / relativePath).wstring();
+
+				auto [writeIndex, inserted] = writeIndexes.try_emplace(normalizeArchivePath(write.Destination), writes.size());
+				if (inserted)
+				{
+					writes.push_back(write);
+				}
+				else
+				{
+					writes[writeIndex->second] = write;
+				}
+			}
+		}
+
+		uint64_t totalSize = 0;
+		for (const ItemWrite& write : writes)
+		{
+			totalSize += write.Size;
+		}
+
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"Installing {} items straight from \"{}\"", writes.size(), FileName.GetFullFileName()), NosLib::Logging::Severity::Info);
+
+		uint64_t writtenSize = 0;
+		for (const ItemWrite& write : writes)
+		{
+			std::filesystem::create_directories(std::filesystem::path(write.Destination).parent_path());
+
+			/* the old file can be a hardlink into an extract directory, truncating it would change that file too */
+			std::error_code ec;
+			std::filesystem::remove(write.Destination, ec);
+
+			std::ofstream outFile(write.Destination, std::ios::binary | std::ios::trunc);
+			if (!outFile.is_open())
+			{
+				NosLib::Logging::CreateLog<wchar_t>(std::format(L"Failed to open \"{}\" for writing", write.Destination), NosLib::Logging::Severity::Error);
+				return false;
+			}
+
+			/* hashed on the way to the disk, for the install manifest */
+			XXH64StreamBuffer hashingBuffer(outFile.rdbuf());
+			std::ostream outStream(&hashingBuffer);
+
+			reader->extractTo(outStream, write.Index);
+			outStream.flush();
+			outFile.close();
+
+			if (outStream.fail() || outFile.fail())
+			{
+				NosLib::Logging::CreateLog<wchar_t>(std::format(L"Failed to write \"{}\"", write.Destination), NosLib::Logging::Severity::Error);
+				return false;
+			}
+
+			InstallManifest::AddFile(owner, write.Destination, hashingBuffer.HexDigest());
+
+			writtenSize += write.Size;
+			(callerPointer->*progressCallback)(writtenSize, (totalSize == 0 ? 1 : totalSize));
+		}
+	}
+	catch (const bit7z::BitException& ex)
+	{
+		logExtractException(ex);
+		return false;
+	}
+	catch (const std::filesystem::filesystem_error& ex)
+	{
+		NosLib::Logging::CreateLog<wchar_t>(NosLib::String::ToWstring(ex.what()), NosLib::Logging::Severity::Error);
+		return false;
+	}
+
 	return true;
 }
 
@@ -155,37 +1015,106 @@ bool File::ExtractFile()
 	/* create directories in order to prevent any errors */
 	std::filesystem::create_directories(GetExtractPath());
 
-	NosLib::Logging::CreateLog<wchar_t>(std::format(L"Extracting \"{}\" To \"{}\"", GetDownloadPath(), GetExtractPath()), NosLib::Logging::Severity::Info);
+	std::wstring sourceName = (InMemory ? std::format(L"{} (memory)", FileName.GetFullFileName()) : GetDownloadPath());
+	NosLib::Logging::CreateLog<wchar_t>(std::format(L"Extracting \"{}\" To \"{}\"", sourceName, GetExtractPath()), NosLib::Logging::Severity::Info);
 
 	uint64_t totalSize = 1;
-	extractor.setTotalCallback([&](uint64_t total_size)
+	uint64_t countedSize = 0;
+	uint64_t countedProcessed = 0;
+	auto totalCallback = [&](uint64_t total_size)
 	{
 		totalSize = total_size;
-	});
+		countedSize = total_size;
+		InstallEstimator::AddExtractSize(total_size);
+	};
 
-	extractor.setProgressCallback([&](uint64_t processed_size)
+	auto progressCallback = [&](uint64_t processed_size)
 	{
+		if (processed_size > countedProcessed)
+		{
+			InstallEstimator::AddExtracted(processed_size - countedProcessed);
+			countedProcessed = processed_size;
+		}
+
 		return (CallerPointer->*ProgressCallback)(processed_size, totalSize);
-	});
+	};
+
+	/* anything left of the estimate is done now (or never will be). Files with nothing to extract count as 0 bytes */
+	auto finishEstimate = [&]()
+	{
+		if (countedSize == 0)
+		{
+			InstallEstimator::AddExtractSize(0);
+		}
+
+		if (countedSize > countedProcessed)
+		{
+			InstallEstimator::AddExtracted(countedSize - countedProcessed);
+		}
+	};
 
 	try
 	{
 		(CallerPointer->*StatusCallback)(std::format(L"Extracting \"{}\"", FileName.GetFullFileName()));
-		extractor.extract(GetDownloadPath(), GetExtractPath());
-	}
-	catch (const bit7z::BitException& ex)
-	{
-		std::wstring errorMessage;
-		for (std::pair<std::wstring, std::error_code> entry : ex.failedFiles())
+
+		/* read the archive index first, only the items users will copy out get extracted */
+		std::unique_ptr<bit7z::BitArchiveReader> reader = OpenArchive();
+
+		/* items in non solid archives can be read one by one cheaply, users write them straight to their destination when installing.
+		 * solid archives would get decompressed again for every item, those still go through the extract directory */
+		if (!reader->isSolid() && !ExtractRules.empty())
+		{
+			reader.reset();
+
+			/* in memory archives stay in memory until every user installed from them, InMemoryTotalLimit keeps that bounded */
+			DirectInstall = true;
+			NosLib::Logging::CreateLog<wchar_t>(std::format(L"\"{}\" isn't solid, installing straight from the archive", sourceName), NosLib::Logging::Severity::Info);
+			finishEstimate();
+			return true;
+		}
+
+		if (ExtractedItems.size() != reader->itemsCount())
+		{
+			ExtractedItems.assign(reader->itemsCount(), false);
+		}
+
+		std::vector<uint32_t> wantedItems;
+		for (const bit7z::BitArchiveItem& item : reader->items())
+		{
+			if (!ExtractedItems[item.index()] && WantsItem(normalizeArchivePath(item.path())))
+			{
+				wantedItems.push_back(item.index());
+			}
+		}
+
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"Extracting {} of {} items from \"{}\"", wantedItems.size(), reader->itemsCount(), sourceName), NosLib::Logging::Severity::Debug);
+
+		if (!wantedItems.empty())
+		{
+			reader->setTotalCallback(totalCallback);
+			reader->setProgressCallback(progressCallback);
+			reader->extractTo(GetExtractPath(), wantedItems);
+		}
+
+		for (uint32_t index : wantedItems)
 		{
-			errorMessage += std::format(L"{} : {}\n", entry.first, NosLib::String::ToWstring(entry.second.message()));
+			ExtractedItems[index] = true;
 		}
 
-		errorMessage += NosLib::String::ToWstring(std::format("{}\n", ex.what()));
-		NosLib::Logging::CreateLog<wchar_t>(errorMessage, NosLib::Logging::Severity::Error);
+		reader.reset();
+
+		/* extracted, no need to hold onto it anymore */
+		FreeArchiveBuffer();
+	}
+	catch (const bit7z::BitException& ex)
+	{
+		logExtractException(ex);
+		FreeArchiveBuffer();
+		finishEstimate();
 		return false;
 	}
-	NosLib::Logging::CreateLog<wchar_t>(std::format(L"Extracted \"{}\" To \"{}\"", GetDownloadPath(), GetExtractPath()), NosLib::Logging::Severity::Info);
+	finishEstimate();
+	NosLib::Logging::CreateLog<wchar_t>(std::format(L"Extracted \"{}\" To \"{}\"", sourceName, GetExtractPath()), NosLib::Logging::Severity::Info);
 
 	return true;
-}
\ No newline at end of file
+}
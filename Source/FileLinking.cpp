@@ -0,0 +1,311 @@
+#include "../Headers/FileLinking.hpp"
+
+#include "../Headers/InstallOptions.hpp"
+#include "../Headers/InstallManifest.hpp"
+#include "../Headers/Hash.hpp"
+
+#include <fstream>
+#include <vector>
+#include <unordered_set>
+#include <mutex>
+#include <future>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <winioctl.h>
+#elif defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/sendfile.h>
+#include <linux/fs.h>
+#include <cerrno>
+#endif // _WIN32
+
+#ifdef _WIN32
+/* ReFS block cloning, FSCTL_DUPLICATE_EXTENTS_TO_FILE has to work on whole clusters */
+static bool cloneFileWindows(const std::filesystem::path& from, const std::filesystem::path& to, bool* supported)
+{
+	HANDLE source = CreateFileW(from.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 0, nullptr);
+	if (source == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	DWORD fileSystemFlags = 0;
+	if (!GetVolumeInformationByHandleW(source, nullptr, 0, nullptr, nullptr, &fileSystemFlags, nullptr, 0) || !(fileSystemFlags & FILE_SUPPORTS_BLOCK_REFCOUNTING))
+	{
+		*supported = false;
+		CloseHandle(source);
+		return false;
+	}
+
+	FSCTL_GET_INTEGRITY_INFORMATION_BUFFER integrityInfo;
+	DWORD returnedBytes = 0;
+	if (!DeviceIoControl(source, FSCTL_GET_INTEGRITY_INFORMATION, nullptr, 0, &integrityInfo, sizeof(integrityInfo), &returnedBytes, nullptr))
+	{
+		*supported = false;
+		CloseHandle(source);
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(source, &fileSize);
+
+	HANDLE target = CreateFileW(to.c_str(), GENERIC_READ | GENERIC_WRITE | DELETE, 0, nullptr, CREATE_ALWAYS, 0, nullptr);
+	if (target == INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(source);
+		return false;
+	}
+
+	/* target needs to be the right size before extents can be cloned into it */
+	FILE_END_OF_FILE_INFO endOfFile;
+	endOfFile.EndOfFile = fileSize;
+	bool cloned = SetFileInformationByHandle(target, FileEndOfFileInfo, &endOfFile, sizeof(endOfFile));
+
+	const LONGLONG clusterSize = integrityInfo.ClusterSizeInBytes;
+	const LONGLONG chunkSize = (1ll << 30); /* clones are limited to less than 4GB at a time */
+
+	for (LONGLONG offset = 0; cloned && offset < fileSize.QuadPart; offset += chunkSize)
+	{
+		LONGLONG byteCount = fileSize.QuadPart - offset;
+		byteCount = (byteCount > chunkSize ? chunkSize : byteCount);
+		byteCount = ((byteCount + clusterSize - 1) / clusterSize) * clusterSize; /* round up the tail, file size was already set */
+
+		DUPLICATE_EXTENTS_DATA extents;
+		extents.FileHandle = source;
+		extents.SourceFileOffset.QuadPart = offset;
+		extents.TargetFileOffset.QuadPart = offset;
+		extents.ByteCount.QuadPart = byteCount;
+
+		cloned = DeviceIoControl(target, FSCTL_DUPLICATE_EXTENTS_TO_FILE, &extents, sizeof(extents), nullptr, 0, &returnedBytes, nullptr);
+	}
+
+	if (!cloned)
+	{
+		/* don't leave a half cloned file behind, the caller falls back to copying */
+		FILE_DISPOSITION_INFO disposition;
+		disposition.DeleteFile = TRUE;
+		SetFileInformationByHandle(target, FileDispositionInfo, &disposition, sizeof(disposition));
+	}
+
+	CloseHandle(target);
+	CloseHandle(source);
+	return cloned;
+}
+#endif // _WIN32
+
+/* volume pairs which can't clone (NTFS, ext4, across volumes), so every file doesn't have to find out again */
+static std::mutex UnsupportedVolumesMutex;
+static std::unordered_set<std::wstring> UnsupportedVolumes;
+
+static std::wstring cloneVolumeKey(const std::filesystem::path& from, const std::filesystem::path& to)
+{
+	#ifdef __linux__
+	struct stat sourceInfo;
+	struct stat targetInfo;
+	if (stat(from.c_str(), &sourceInfo) == -1 || stat(to.parent_path().c_str(), &targetInfo) == -1)
+	{
+		return L"";
+	}
+
+	return std::to_wstring(sourceInfo.st_dev) + L"|" + std::to_wstring(targetInfo.st_dev);
+	#else
+	return from.root_name().wstring() + L"|" + to.root_name().wstring();
+	#endif // __linux__
+}
+
+static bool cloneFileNative(const std::filesystem::path& from, const std::filesystem::path& to, bool* supported)
+{
+	#ifdef _WIN32
+	return cloneFileWindows(from, to, supported);
+	#elif defined(__linux__)
+	int source = open(from.c_str(), O_RDONLY);
+	if (source == -1)
+	{
+		return false;
+	}
+
+	int target = open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (target == -1)
+	{
+		close(source);
+		return false;
+	}
+
+	bool cloned = (ioctl(target, FICLONE, source) == 0);
+	*supported = (cloned || (errno != EOPNOTSUPP && errno != EXDEV && errno != EINVAL && errno != ENOTTY));
+
+	close(target);
+	close(source);
+
+	if (!cloned)
+	{
+		unlink(to.c_str());
+	}
+	return cloned;
+	#else
+	return false;
+	#endif // _WIN32
+}
+
+bool FileLinking::CloneFile(const std::filesystem::path& from, const std::filesystem::path& to)
+{
+	std::wstring volumeKey = cloneVolumeKey(from, to);
+
+	{
+		std::lock_guard<std::mutex> lk(UnsupportedVolumesMutex);
+		if (UnsupportedVolumes.contains(volumeKey))
+		{
+			return false;
+		}
+	}
+
+	bool supported = true;
+	bool cloned = cloneFileNative(from, to, &supported);
+
+	if (!supported)
+	{
+		std::lock_guard<std::mutex> lk(UnsupportedVolumesMutex);
+		UnsupportedVolumes.insert(volumeKey);
+	}
+
+	return cloned;
+}
+
+bool FileLinking::CopyFileNative(const std::filesystem::path& from, const std::filesystem::path& to)
+{
+	#ifdef _WIN32
+	/* lets windows pick the buffer sizes and unbuffered io for large files, overwrites the target */
+	return CopyFileExW(from.c_str(), to.c_str(), nullptr, nullptr, nullptr, 0);
+	#elif defined(__linux__)
+	int source = open(from.c_str(), O_RDONLY);
+	if (source == -1)
+	{
+		return false;
+	}
+
+	struct stat sourceInfo;
+	if (fstat(source, &sourceInfo) == -1)
+	{
+		close(source);
+		return false;
+	}
+
+	int target = open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (target == -1)
+	{
+		close(source);
+		return false;
+	}
+
+	const size_t chunkSize = 64 * 1024 * 1024;
+	off_t remaining = sourceInfo.st_size;
+	bool useSendfile = false;
+
+	while (remaining > 0)
+	{
+		size_t wanted = (remaining > static_cast<off_t>(chunkSize) ? chunkSize : static_cast<size_t>(remaining));
+		ssize_t copied = (useSendfile ? sendfile(target, source, nullptr, wanted) : copy_file_range(source, nullptr, target, nullptr, wanted, 0));
+
+		/* older kernels can't copy_file_range across filesystems, sendfile still keeps the bytes in the kernel */
+		if (copied == -1 && !useSendfile && (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP) && remaining == sourceInfo.st_size)
+		{
+			useSendfile = true;
+			continue;
+		}
+
+		if (copied <= 0)
+		{
+			break;
+		}
+
+		remaining -= copied;
+	}
+
+	close(target);
+	close(source);
+
+	if (remaining != 0)
+	{
+		unlink(to.c_str());
+		return false;
+	}
+	return true;
+	#else
+	return false;
+	#endif // _WIN32
+}
+
+bool FileLinking::CopyFileHashed(const std::filesystem::path& from, const std::filesystem::path& to, std::string* hexDigest)
+{
+	std::ifstream source(from, std::ios::binary);
+	std::ofstream target(to, std::ios::binary | std::ios::trunc);
+
+	if (!source.is_open() || !target.is_open())
+	{
+		return false;
+	}
+
+	XXH64Hasher hasher;
+	/* reused for every file the worker copies, most files are tiny scripts */
+	thread_local std::vector<char> chunk(1024 * 1024);
+
+	while (source)
+	{
+		source.read(chunk.data(), chunk.size());
+		std::streamsize readBytes = source.gcount();
+
+		hasher.Update(chunk.data(), static_cast<size_t>(readBytes));
+		target.write(chunk.data(), readBytes);
+	}
+
+	if (source.bad() || !target.good())
+	{
+		return false;
+	}
+
+	*hexDigest = hasher.HexDigest();
+	return true;
+}
+
+void FileLinking::InstallFile(const std::filesystem::path& from, const std::filesystem::path& to, const std::wstring& owner)
+{
+	std::error_code ec;
+	std::string hash;
+
+	/* an earlier mod can have hardlinked the target, writing into it would change the extracted file (and every other link to it) as well.
+	 * the link or copy has to be a new file */
+	std::filesystem::remove(to, ec);
+
+	/* links don't move any bytes, so the source gets read once for the hash. Small copies hash while copying */
+	bool linked = false;
+	if (InstallOptions::UseHardlinks)
+	{
+		std::filesystem::create_hard_link(from, to, ec);
+		linked = !ec;
+	}
+
+	bool copied = (linked || CloneFile(from, to));
+	if (copied)
+	{
+		XXH64Hasher::HashFile(from.wstring(), &hash);
+	}
+	else if (std::filesystem::file_size(from, ec) >= NativeCopyThreshold)
+	{
+		/* the system copies large files without the bytes going through the program, the source gets hashed by a read only pass next to it.
+		 * it was just extracted, so both mostly read from the cache */
+		std::future<bool> hashed = std::async(std::launch::async, &XXH64Hasher::HashFile, from.wstring(), &hash);
+		copied = CopyFileNative(from, to);
+		copied &= hashed.get();
+	}
+
+	if (!copied && !CopyFileHashed(from, to, &hash))
+	{
+		throw std::filesystem::filesystem_error("Failed to copy file", from, to, std::make_error_code(std::errc::io_error));
+	}
+
+	InstallManifest::AddFile(owner, to, hash);
+}
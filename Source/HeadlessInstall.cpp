@@ -0,0 +1,260 @@
+#include "../Headers/HeadlessInstall.hpp"
+#include "../Headers/InstallManager.hpp"
+#include "../Headers/InstallOptions.hpp"
+#include "../Headers/ConsoleProgressSink.hpp"
+#include "../Headers/BandwidthLimiter.hpp"
+#include "../Headers/Validation.hpp"
+
+#include <NosLib/Logging.hpp>
+#include <NosLib/String.hpp>
+
+#include <QCoreApplication>
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif // _WIN32
+
+#include <iostream>
+#include <string>
+#include <format>
+
+/* same form the path inputs of the window give: long path prefix, one kind of separator and a trailing separator */
+static std::wstring makeSystemPath(std::wstring path)
+{
+	#ifdef _WIN32
+	std::wstring prefix = LR"(\\?\)";
+	wchar_t usedSeparator = L'\\';
+	wchar_t wrongSeparator = L'/';
+	#else
+	std::wstring prefix = L"";
+	wchar_t usedSeparator = L'/';
+	wchar_t wrongSeparator = L'\\';
+	#endif // _WIN32
+
+	for (wchar_t& pathLetter : path)
+	{
+		if (pathLetter == wrongSeparator)
+		{
+			pathLetter = usedSeparator;
+		}
+	}
+
+	if (path.empty())
+	{
+		return path;
+	}
+
+	if (path.back() != usedSeparator)
+	{
+		path.push_back(usedSeparator);
+	}
+
+	if (path.rfind(prefix, 0) != 0)
+	{
+		path.insert(0, prefix);
+	}
+
+	return path;
+}
+
+static void printUsage()
+{
+	std::cout << "Usage: NCGI --headless --anomaly <path> --gamma <path> [options]\n"
+		"Options:\n"
+		"  --no-overwrite           don't add the overwrite files\n"
+		"  --update                 only install the mods which changed since the last install\n"
+		"  --verify                 only reinstall mods with missing or damaged files\n"
+		"  --hardlinks              install files as hardlinks\n"
+		"  --cache [directory]      keep downloaded archives in the archive cache\n"
+		"  --probe-mirrors          pick the fastest ModDB mirror for each mod\n"
+		"  --limit <MB/s>           limit the download speed\n"
+		"  --download-threads <n>   amount of download workers\n"
+		"  --extract-threads <n>    amount of extract workers\n"
+		"  --install-threads <n>    amount of install workers\n"
+		"  --json                   print progress as 1 JSON object per line\n"
+		"Exit codes:\n"
+		"  0  everything got installed\n"
+		"  1  some mods failed to install (details are in the log)\n"
+		"  2  invalid arguments\n";
+}
+
+bool HeadlessInstall::IsRequested(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::string(argv[i]) == "--headless")
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int HeadlessInstall::Run(int argc, char* argv[])
+{
+	#ifdef _WIN32
+	/* built as a window program, so there is no console to print to unless it gets attached to the one it was started from */
+	if (AttachConsole(ATTACH_PARENT_PROCESS) || AllocConsole())
+	{
+		FILE* consoleOut;
+		freopen_s(&consoleOut, "CONOUT$", "w", stdout);
+		std::cout.clear();
+	}
+	#endif // _WIN32
+
+	ConsoleProgressSink::Format outputFormat = ConsoleProgressSink::Format::Text;
+	std::wstring anomalyPath;
+	std::wstring gammaPath;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string argument = argv[i];
+		bool hasValue = (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0);
+
+		try
+		{
+			if (argument == "--headless")
+			{
+				continue;
+			}
+			else if (argument == "--anomaly" && hasValue)
+			{
+				anomalyPath = NosLib::String::ToWstring(argv[++i]);
+			}
+			else if (argument == "--gamma" && hasValue)
+			{
+				gammaPath = NosLib::String::ToWstring(argv[++i]);
+			}
+			else if (argument == "--no-overwrite")
+			{
+				InstallOptions::AddOverwriteFiles = false;
+			}
+			else if (argument == "--update")
+			{
+				InstallOptions::UpdateExistingInstall = true;
+			}
+			else if (argument == "--verify")
+			{
+				InstallOptions::VerifyExistingInstall = true;
+			}
+			else if (argument == "--hardlinks")
+			{
+				InstallOptions::UseHardlinks = true;
+			}
+			else if (argument == "--cache")
+			{
+				InstallOptions::UseArchiveCache = true;
+				if (hasValue)
+				{
+					InstallOptions::ArchiveCacheDirectory = NosLib::String::ToWstring(argv[++i]);
+				}
+			}
+			else if (argument == "--probe-mirrors")
+			{
+				InstallOptions::ProbeMirrors = true;
+			}
+			else if (argument == "--limit" && hasValue)
+			{
+				BandwidthLimiter::SetGlobalRate(std::stoull(argv[++i]) * 1024 * 1024);
+			}
+			else if (argument == "--download-threads" && hasValue)
+			{
+				InstallOptions::DownloadThreads = std::stoi(argv[++i]);
+			}
+			else if (argument == "--extract-threads" && hasValue)
+			{
+				InstallOptions::ExtractThreads = std::stoi(argv[++i]);
+			}
+			else if (argument == "--install-threads" && hasValue)
+			{
+				InstallOptions::InstallThreads = std::stoi(argv[++i]);
+			}
+			else if (argument == "--help")
+			{
+				printUsage();
+				return 0;
+			}
+			else if (argument == "--json")
+			{
+				outputFormat = ConsoleProgressSink::Format::Json;
+			}
+			else
+			{
+				std::cout << std::format("Unknown or incomplete argument \"{}\"\n", argument);
+				printUsage();
+				return 2;
+			}
+		}
+		catch (const std::exception&)
+		{
+			std::cout << std::format("Invalid value for \"{}\"\n", argument);
+			printUsage();
+			return 2;
+		}
+	}
+
+	/* also catches --gamma "" */
+	if (anomalyPath.empty() || gammaPath.empty())
+	{
+		std::cout << "Both --anomaly and --gamma need a path\n";
+		printUsage();
+		return 2;
+	}
+
+	if (InstallOptions::DownloadThreads < 1 || InstallOptions::ExtractThreads < 1 || InstallOptions::InstallThreads < 1)
+	{
+		std::cout << "Worker counts have to be at least 1\n";
+		return 2;
+	}
+
+	InstallOptions::StalkerAnomalyPath = makeSystemPath(anomalyPath);
+	InstallOptions::GammaInstallPath = makeSystemPath(gammaPath);
+
+	NosLib::Logging::CreateLog<wchar_t>(std::format(L"Headless install | Stalker Anomaly Path: \"{}\" | Gamma Install Path: \"{}\"",
+													InstallOptions::StalkerAnomalyPath,
+													InstallOptions::GammaInstallPath),
+										NosLib::Logging::Severity::Info);
+
+	if (!Validation::ValidateStalkerAnomalyPath(QString::fromStdWString(InstallOptions::StalkerAnomalyPath)))
+	{
+		std::cout << "Invalid Stalker Anomaly path\n";
+		return 2;
+	}
+
+	/* no widgets, but the install manager is still a QObject */
+	QCoreApplication app(argc, argv);
+
+	ConsoleProgressSink progressSink(outputFormat);
+
+	InstallManager* installManager = InstallManager::GetInstallManager();
+	installManager->ProgressContainer = &progressSink;
+
+	/* emitted on this thread, so these run straight away */
+	QObject::connect(installManager, &InstallManager::FinishInstallerInitializing, [&progressSink]()
+	{
+		progressSink.StartEstimate();
+	});
+
+	QObject::connect(installManager, &InstallManager::FinishInstalling, [&progressSink](const std::wstring& timeTaken)
+	{
+		progressSink.Finish(timeTaken);
+	});
+
+	installManager->StartInstall();
+
+	if (installManager->GetFailedModCount() > 0)
+	{
+		if (outputFormat == ConsoleProgressSink::Format::Json)
+		{
+			std::cout << std::format("{{\"event\":\"failed\",\"mods\":{}}}\n", installManager->GetFailedModCount());
+		}
+		else
+		{
+			std::cout << std::format("{} mods failed to install\n", installManager->GetFailedModCount());
+		}
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,131 @@
+#include "../Headers/HostGovernor.hpp"
+
+#include <NosLib/Logging.hpp>
+#include <NosLib/String.hpp>
+
+#include <format>
+#include <random>
+#include <thread>
+
+HostGovernor::Permit::~Permit()
+{
+	{
+		std::lock_guard<std::mutex> lk(State->StateMutex);
+		State->Active--;
+	}
+
+	State->SlotFreed.notify_one();
+}
+
+void HostGovernor::Permit::Report(const Outcome& outcome)
+{
+	std::unique_lock<std::mutex> lk(State->StateMutex);
+
+	switch (outcome)
+	{
+	case Outcome::Healthy:
+		/* additive increase, about 1 more slot once every slot had a healthy response */
+		State->Limit += 1.0 / State->Limit;
+		if (State->Limit > MaxLimit)
+		{
+			State->Limit = MaxLimit;
+		}
+
+		lk.unlock();
+		State->SlotFreed.notify_one();
+		break;
+
+	case Outcome::Throttled:
+	{
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		if (now - State->LastDecrease < DecreaseCooldown)
+		{
+			break;
+		}
+
+		/* multiplicative decrease */
+		State->Limit = (State->Limit / 2 < 1 ? 1 : State->Limit / 2);
+		State->LastDecrease = now;
+
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"Host is throttling, lowered parallel requests to {}", static_cast<int>(State->Limit)), NosLib::Logging::Severity::Warning);
+		break;
+	}
+
+	case Outcome::Failed:
+		break;
+	}
+}
+
+std::unique_ptr<HostGovernor::Permit> HostGovernor::Acquire(const std::string& hostUrl)
+{
+	HostState* state = GetHostState(hostUrl);
+
+	std::unique_lock<std::mutex> lk(state->StateMutex);
+	state->SlotFreed.wait(lk, [state]() { return state->Active < static_cast<int>(state->Limit); });
+	state->Active++;
+
+	return std::make_unique<Permit>(state);
+}
+
+HostGovernor::Outcome HostGovernor::Classify(const httplib::Result& result)
+{
+	return Classify(result ? result->status : 0);
+}
+
+HostGovernor::Outcome HostGovernor::Classify(const int& status)
+{
+	/* timeouts and dropped connections are how overloaded hosts usually start */
+	if (status == 0)
+	{
+		return Outcome::Throttled;
+	}
+
+	if (status == 503 || status == 429)
+	{
+		return Outcome::Throttled;
+	}
+
+	if (status >= 400)
+	{
+		return Outcome::Failed;
+	}
+
+	return Outcome::Healthy;
+}
+
+void HostGovernor::WaitBeforeRetry(const int& attempt)
+{
+	thread_local std::mt19937 generator(std::random_device{}());
+
+	int shift = (attempt < 5 ? attempt : 5);
+	std::chrono::milliseconds delay = RetryBaseDelay * (1 << shift);
+	if (delay > RetryMaxDelay)
+	{
+		delay = RetryMaxDelay;
+	}
+
+	/* anywhere from half to the full delay */
+	std::uniform_int_distribution<long long> jitter(delay.count() / 2, delay.count());
+	std::this_thread::sleep_for(std::chrono::milliseconds(jitter(generator)));
+}
+
+int HostGovernor::GetLimit(const std::string& hostUrl)
+{
+	HostState* state = GetHostState(hostUrl);
+
+	std::lock_guard<std::mutex> lk(state->StateMutex);
+	return static_cast<int>(state->Limit);
+}
+
+HostGovernor::HostState* HostGovernor::GetHostState(const std::string& hostUrl)
+{
+	std::lock_guard<std::mutex> lk(HostsMutex);
+
+	std::unique_ptr<HostState>& state = Hosts[hostUrl];
+	if (state == nullptr)
+	{
+		state = std::make_unique<HostState>();
+	}
+
+	return state.get();
+}
@@ -0,0 +1,131 @@
+#include "../Headers/InstallEstimator.hpp"
+
+uint64_t InstallEstimator::Stage::GetRemaining(const int& fileCount) const
+{
+	uint64_t knownTotal = KnownTotal.load(std::memory_order_relaxed);
+	uint64_t done = Done.load(std::memory_order_relaxed);
+	int sizedFiles = SizedFiles.load(std::memory_order_relaxed);
+
+	uint64_t averageSize = (sizedFiles == 0 ? DefaultFileSize : knownTotal / sizedFiles);
+	uint64_t unsizedFiles = (fileCount > sizedFiles ? fileCount - sizedFiles : 0);
+
+	/* retried downloads can count bytes twice */
+	uint64_t knownRemaining = (knownTotal > done ? knownTotal - done : 0);
+
+	return knownRemaining + (unsizedFiles * averageSize);
+}
+
+void InstallEstimator::Start(const int& fileCount, const int& modCount)
+{
+	std::lock_guard<std::mutex> lk(SampleMutex);
+
+	for (Stage* stage : { &Download, &Extract })
+	{
+		stage->KnownTotal = 0;
+		stage->Done = 0;
+		stage->SizedFiles = 0;
+		stage->LastDone = 0;
+		stage->Rate = 0;
+	}
+
+	FileCount = fileCount;
+	ModCount = modCount;
+	CompletedMods = 0;
+	LastSample = std::chrono::steady_clock::now();
+}
+
+void InstallEstimator::AddDownloadSize(const uint64_t& bytes)
+{
+	Download.KnownTotal.fetch_add(bytes, std::memory_order_relaxed);
+	Download.SizedFiles.fetch_add(1, std::memory_order_relaxed);
+}
+
+void InstallEstimator::AddDownloaded(const uint64_t& bytes)
+{
+	Download.Done.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void InstallEstimator::AddExtractSize(const uint64_t& bytes)
+{
+	Extract.KnownTotal.fetch_add(bytes, std::memory_order_relaxed);
+	Extract.SizedFiles.fetch_add(1, std::memory_order_relaxed);
+}
+
+void InstallEstimator::AddExtracted(const uint64_t& bytes)
+{
+	Extract.Done.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void InstallEstimator::ModCompleted()
+{
+	CompletedMods.fetch_add(1, std::memory_order_relaxed);
+}
+
+InstallEstimator::Estimate InstallEstimator::Sample()
+{
+	std::lock_guard<std::mutex> lk(SampleMutex);
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(now - LastSample).count();
+	LastSample = now;
+
+	Estimate estimate;
+	estimate.DownloadBytesPerSecond = UpdateRate(&Download, seconds);
+	estimate.ExtractBytesPerSecond = UpdateRate(&Extract, seconds);
+
+	int fileCount = FileCount.load(std::memory_order_relaxed);
+	uint64_t downloadRemaining = Download.GetRemaining(fileCount);
+	uint64_t extractRemaining = Extract.GetRemaining(fileCount);
+	uint64_t done = Download.Done.load(std::memory_order_relaxed) + Extract.Done.load(std::memory_order_relaxed);
+	uint64_t remaining = downloadRemaining + extractRemaining;
+
+	int completedMods = CompletedMods.load(std::memory_order_relaxed);
+	int modCount = ModCount.load(std::memory_order_relaxed);
+
+	if (completedMods >= modCount)
+	{
+		estimate.Percentage = 100;
+		estimate.SecondsLeft = 0;
+		return estimate;
+	}
+
+	/* nothing downloaded or extracted (everything was already there), mod count is all there is to go off */
+	if (done + remaining == 0)
+	{
+		estimate.Percentage = (completedMods * 100) / modCount;
+		return estimate;
+	}
+
+	/* installing the last mods still takes a moment after the last byte */
+	estimate.Percentage = static_cast<int>((done * 100) / (done + remaining));
+	estimate.Percentage = (estimate.Percentage > 99 ? 99 : estimate.Percentage);
+
+	/* stages run at the same time, whichever takes longer decides when the install finishes */
+	double downloadSeconds = (downloadRemaining == 0 ? 0 : (estimate.DownloadBytesPerSecond > 0 ? downloadRemaining / estimate.DownloadBytesPerSecond : -1));
+	double extractSeconds = (extractRemaining == 0 ? 0 : (estimate.ExtractBytesPerSecond > 0 ? extractRemaining / estimate.ExtractBytesPerSecond : -1));
+
+	if (downloadSeconds >= 0 && extractSeconds >= 0)
+	{
+		estimate.SecondsLeft = (downloadSeconds > extractSeconds ? downloadSeconds : extractSeconds);
+	}
+
+	return estimate;
+}
+
+double InstallEstimator::UpdateRate(Stage* stage, const double& seconds)
+{
+	uint64_t done = stage->Done.load(std::memory_order_relaxed);
+	uint64_t newBytes = done - stage->LastDone;
+	stage->LastDone = done;
+
+	if (seconds <= 0)
+	{
+		return stage->Rate;
+	}
+
+	double currentRate = newBytes / seconds;
+
+	/* first sample with anything happening sets the rate straight away, instead of slowly rising from 0 */
+	stage->Rate = (stage->Rate == 0 ? currentRate : (RateSmoothing * currentRate) + ((1 - RateSmoothing) * stage->Rate));
+	return stage->Rate;
+}
@@ -1,34 +1,55 @@
 #include "../Headers/InstallManager.hpp"
 
-#include <NosLib/ThreadPool.hpp>
-
 #include "../Headers/ModOrganizer.hpp"
 #include "../Headers/ModInfo.hpp"
 #include "../Headers/File.hpp"
-#include "../Headers/ModProcessorThread.hpp"
+#include "../Headers/InstallPipeline.hpp"
+#include "../Headers/ArchiveCache.hpp"
+#include "../Headers/MirrorProber.hpp"
+#include "../Headers/ModpackUpdate.hpp"
+#include "../Headers/InstallManifest.hpp"
+#include "../Headers/InstallRepair.hpp"
 
 void InstallManager::InitializeInstaller()
 {
 	File::SetDirectories(InstallOptions::GammaInstallPath + InstallInfo::DownloadDirectory, InstallOptions::GammaInstallPath + InstallInfo::ExtractDirectory);
-	RegisteredStatusProgress = ProgressContainer->RegisterProgressBar();
+
+	InstallManifest::Load(InstallOptions::GammaInstallPath);
+
+	/* checked before anything gets installed over it */
+	std::unordered_set<std::wstring> damagedOwners;
+	if (InstallOptions::VerifyExistingInstall)
+	{
+		damagedOwners = InstallRepair::FindDamagedOwners();
+	}
+
+	if (InstallOptions::UseArchiveCache)
+	{
+		ArchiveCache::Initialize(InstallOptions::ArchiveCacheDirectory, InstallOptions::ArchiveCacheSizeLimit);
+	}
+
+	if (InstallOptions::ProbeMirrors)
+	{
+		MirrorProber::Initialize(L"");
+	}
+	StatusSlot = ProgressContainer->RegisterProgressBar();
 
 	/* Set to 0 to disable the Initial set up and only download mods */
 	#if 1
-	connect(this, &InstallManager::ModUpdateProgress, RegisteredStatusProgress, &ProgressStatus::UpdateProgress);
-	connect(this, &InstallManager::ModUpdateStatus, RegisteredStatusProgress, &ProgressStatus::UpdateStatus);
-
 	ModInfo modOrganizer = MO::GetModOrganizerModObject();
 	modOrganizer.ProcessMod(nullptr);
+	FailedModCount += (modOrganizer.CheckIfFailed() ? 1 : 0);
 
 	MO::WriteConfigFile(InstallOptions::GammaInstallPath, InstallOptions::StalkerAnomalyPath);
 
 	ModInfo::AddMod(L"https://github.com/Grokitach/Stalker_GAMMA/archive/refs/heads/main.zip",
-					NosLib::DynamicArray<std::wstring>({ L"\\Stalker_GAMMA-main\\G.A.M.M.A\\modpack_patches" }), InstallOptions::StalkerAnomalyPath, L"G.A.M.M.A. modpack definition", true, false);
+					NosLib::DynamicArray<std::wstring>({ L"\\Stalker_GAMMA-main\\G.A.M.M.A\\modpack_patches" }), InstallOptions::StalkerAnomalyPath, L"G.A.M.M.A. modpack definition", {}, false);
 
 	ModInfo initializeMod(L"https://github.com/Grokitach/Stalker_GAMMA/archive/refs/heads/main.zip",
 						  NosLib::DynamicArray<std::wstring>({ L"\\Stalker_GAMMA-main\\G.A.M.M.A\\modpack_data\\", L"\\Stalker_GAMMA-main\\G.A.M.M.A_definition_version.txt" }),
 						  InstallOptions::GammaInstallPath + InstallInfo::ExtractDirectory, L"G.A.M.M.A. modpack definition", false);
 	initializeMod.ProcessMod(nullptr);
+	FailedModCount += (initializeMod.CheckIfFailed() ? 1 : 0);
 
 	std::filesystem::create_directories(InstallOptions::GammaInstallPath + L"profiles\\Default\\");
 	std::filesystem::rename(InstallOptions::GammaInstallPath + InstallInfo::ExtractDirectory + L"modlist.txt", InstallOptions::GammaInstallPath + L"profiles\\Default\\modlist.txt");
@@ -36,32 +57,87 @@ void InstallManager::InitializeInstaller()
 	NormalizeModList(InstallOptions::GammaInstallPath + L"profiles\\Default\\modlist.txt");
 	#endif // 0
 
-	ModInfo::AddMod(L"https://github.com/Grokitach/gamma_setup/archive/refs/heads/main.zip",
-					NosLib::DynamicArray<std::wstring>({ L"\\gamma_setup-main\\modpack_addons" }), InstallInfo::ModDirectory, L"G.A.M.M.A. setup files", true);
+	/* Dependencies only hold back installing, every file starts downloading straight away.
+	 * setup and large files write into the same mod folders as the modpack mods and addons, so they go first (in that order) */
+	ModInfo* setupFiles = ModInfo::AddMod(L"https://github.com/Grokitach/gamma_setup/archive/refs/heads/main.zip",
+										  NosLib::DynamicArray<std::wstring>({ L"\\gamma_setup-main\\modpack_addons" }), InstallInfo::ModDirectory, L"G.A.M.M.A. setup files");
 
-	ModInfo::AddMod(L"https://github.com/Grokitach/gamma_large_files_v2/archive/refs/heads/main.zip",
-					NosLib::DynamicArray<std::wstring>({ L"\\gamma_large_files_v2-main" }), InstallInfo::ModDirectory, L"Gamma Large Files", true);
+	ModInfo* largeFiles = ModInfo::AddMod(L"https://github.com/Grokitach/gamma_large_files_v2/archive/refs/heads/main.zip",
+										  NosLib::DynamicArray<std::wstring>({ L"\\gamma_large_files_v2-main" }), InstallInfo::ModDirectory, L"Gamma Large Files", NosLib::DynamicArray<ModInfo*>({ setupFiles }));
 
-				/* parse modpack maker file, put it into global static array */
-	ModInfo::ModpackMakerFile_Parse(InstallOptions::GammaInstallPath + InstallInfo::ExtractDirectory + L"modpack_maker_list.txt");
+	/* parse modpack maker file, put it into global static array */
+	NosLib::DynamicArray<ModInfo*> modpackMods = ModInfo::ModpackMakerFile_Parse(InstallOptions::GammaInstallPath + InstallInfo::ExtractDirectory + L"modpack_maker_list.txt", NosLib::DynamicArray<ModInfo*>({ setupFiles, largeFiles }));
 
 	ModInfo::AddMod(L"https://github.com/Grokitach/Stalker_GAMMA/archive/refs/heads/main.zip",
-					NosLib::DynamicArray<std::wstring>({ L"\\Stalker_GAMMA-main\\G.A.M.M.A\\modpack_addons" }), InstallInfo::ModDirectory, L"G.A.M.M.A. modpack definition");
+					NosLib::DynamicArray<std::wstring>({ L"\\Stalker_GAMMA-main\\G.A.M.M.A\\modpack_addons" }), InstallInfo::ModDirectory, L"G.A.M.M.A. modpack definition", NosLib::DynamicArray<ModInfo*>({ setupFiles, largeFiles }));
 
+	/* overwrite files go over everything, so they wait for every other mod */
 	if (InstallOptions::AddOverwriteFiles)
 	{
 		ModInfo::AddMod(L"https://github.com/Noscka/Norzkas-GAMMA-Overwrite/archive/refs/heads/main.zip",
-						NosLib::DynamicArray<std::wstring>({ L"\\Norzkas-GAMMA-Overwrite-main\\" }), L"", L"Norzkas G.A.M.M.A. files");
+						NosLib::DynamicArray<std::wstring>({ L"\\Norzkas-GAMMA-Overwrite-main\\" }), L"", L"Norzkas G.A.M.M.A. files", ModInfo::ModInfoList);
+	}
+
+	/* needs every mod and its dependencies, a damaged mod takes everything installed after it along */
+	std::unordered_set<std::wstring> reinstallOwners;
+	if (InstallOptions::VerifyExistingInstall)
+	{
+		reinstallOwners = InstallRepair::AddDependents(ModInfo::ModInfoList, damagedOwners);
 	}
 
-	ProgressContainer->UnregisterProgressBar(RegisteredStatusProgress);
+	/* only install what changed since the last install */
+	if (InstallOptions::UpdateExistingInstall)
+	{
+		if (ModpackUpdate::CanUpdate(InstallOptions::GammaInstallPath))
+		{
+			/* setup and large files go under every mod, installing them again would put them over the kept mods' files.
+			 * unchanged ones get kept too, a changed one takes every mod installed after it along */
+			NosLib::DynamicArray<ModInfo*> baseMods({ setupFiles, largeFiles });
+			std::unordered_set<std::wstring> changedOwners = ModpackUpdate::FindChangedFiles(InstallOptions::GammaInstallPath, baseMods);
+			reinstallOwners.merge(InstallRepair::AddDependents(ModInfo::ModInfoList, changedOwners));
+
+			for (ModInfo* mod : baseMods)
+			{
+				if (!reinstallOwners.contains(mod->GetOwnerKey()))
+				{
+					mod->MarkUpToDate();
+				}
+			}
+
+			ModpackUpdate::ApplyDiff(InstallOptions::GammaInstallPath, modpackMods, reinstallOwners);
+		}
+		else
+		{
+			NosLib::Logging::CreateLog<wchar_t>(L"No recorded install to update from, installing everything", NosLib::Logging::Severity::Warning);
+		}
+	}
+
+	if (InstallOptions::VerifyExistingInstall)
+	{
+		InstallRepair::Apply(ModInfo::ModInfoList, reinstallOwners);
+	}
+
+	ProgressContainer->UnregisterProgressBar(StatusSlot);
 }
 
 void InstallManager::MainInstall()
 {
-	NosLib::ThreadPool modProcessThreadPool;
+	InstallPipeline pipeline(ModInfo::ModInfoList);
+	pipeline.Run();
+
+	for (ModInfo* mod : ModInfo::ModInfoList)
+	{
+		if (!mod->CheckIfInstalled())
+		{
+			FailedModCount++;
+		}
+	}
 
-	NosLib::MemberFunctionStore<ModProcessorThread, void(ModProcessorThread::*)()> processFunction(&ModProcessorThread::ProcessMod);
+	if (FailedModCount > 0)
+	{
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"{} mods failed to install", FailedModCount), NosLib::Logging::Severity::Error);
+	}
 
-	modProcessThreadPool.StartThreadPool(processFunction, false, 1.0f);
+	InstallManifest::Save();
+	ModpackUpdate::RecordInstalledList(InstallOptions::GammaInstallPath, InstallOptions::GammaInstallPath + InstallInfo::ExtractDirectory + L"modpack_maker_list.txt", ModInfo::ModInfoList);
 }
\ No newline at end of file
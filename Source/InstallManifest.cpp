@@ -0,0 +1,223 @@
+#include "../Headers/InstallManifest.hpp"
+
+#include <NosLib/Logging.hpp>
+#include <NosLib/String.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <format>
+#include <cwctype>
+
+void InstallManifest::Load(const std::wstring& installPath)
+{
+	std::lock_guard<std::mutex> lk(ManifestMutex);
+
+	InstallPath = installPath;
+	Records.clear();
+
+	std::ifstream manifestFile(GetManifestPath(), std::ios::binary);
+	if (!manifestFile.is_open())
+	{
+		return;
+	}
+
+	/* one file per line, tab separated: owner, path, size, modified time, hash */
+	std::string line;
+	while (std::getline(manifestFile, line))
+	{
+		std::vector<std::string> fields;
+		std::istringstream lineStream(line);
+		std::string field;
+		while (std::getline(lineStream, field, '\t'))
+		{
+			fields.push_back(field);
+		}
+
+		if (fields.size() != 5)
+		{
+			continue;
+		}
+
+		Record record;
+		record.Owner = NosLib::String::ToWstring(fields[0]);
+		record.Path = NosLib::String::ToWstring(fields[1]);
+		record.Hash = fields[4];
+
+		try
+		{
+			record.Size = std::stoull(fields[2]);
+			record.ModifiedTime = std::stoll(fields[3]);
+		}
+		catch (const std::exception&)
+		{
+			NosLib::Logging::CreateLog<wchar_t>(std::format(L"Skipping invalid install manifest line for \"{}\"", record.Path), NosLib::Logging::Severity::Warning);
+			continue;
+		}
+
+		Records[ToKey(record.Path)] = record;
+	}
+
+	NosLib::Logging::CreateLog<wchar_t>(std::format(L"Loaded install manifest with {} files", Records.size()), NosLib::Logging::Severity::Info);
+}
+
+void InstallManifest::AddFile(const std::wstring& owner, const std::filesystem::path& filePath, const std::string& hash)
+{
+	Record record;
+	record.Owner = owner;
+	record.Hash = hash;
+
+	std::error_code ec;
+	record.Size = std::filesystem::file_size(filePath, ec);
+	record.ModifiedTime = std::filesystem::last_write_time(filePath, ec).time_since_epoch().count();
+
+	std::lock_guard<std::mutex> lk(ManifestMutex);
+
+	record.Path = ToManifestPath(filePath);
+	Records[ToKey(record.Path)] = record;
+}
+
+void InstallManifest::RemoveDirectory(const std::filesystem::path& directory)
+{
+	std::lock_guard<std::mutex> lk(ManifestMutex);
+
+	std::wstring prefix = ToKey(AsDirectory(ToManifestPath(directory)));
+
+	std::erase_if(Records, [&](const auto& entry)
+	{
+		return entry.first.starts_with(prefix);
+	});
+}
+
+void InstallManifest::MoveDirectory(const std::filesystem::path& from, const std::filesystem::path& to)
+{
+	std::lock_guard<std::mutex> lk(ManifestMutex);
+
+	std::wstring fromPath = AsDirectory(ToManifestPath(from));
+	std::wstring toPath = AsDirectory(ToManifestPath(to));
+	std::wstring fromPrefix = ToKey(fromPath);
+
+	std::vector<Record> moved;
+	std::erase_if(Records, [&](const auto& entry)
+	{
+		if (!entry.first.starts_with(fromPrefix))
+		{
+			return false;
+		}
+
+		moved.push_back(entry.second);
+		return true;
+	});
+
+	/* only the paths change, owner keys don't depend on the folder name */
+	for (Record& record : moved)
+	{
+		record.Path = toPath + record.Path.substr(fromPath.size());
+		Records[ToKey(record.Path)] = record;
+	}
+}
+
+std::vector<InstallManifest::Record> InstallManifest::GetRecords()
+{
+	std::lock_guard<std::mutex> lk(ManifestMutex);
+
+	std::vector<Record> records;
+	records.reserve(Records.size());
+
+	for (auto& [key, record] : Records)
+	{
+		records.push_back(record);
+	}
+
+	return records;
+}
+
+std::filesystem::path InstallManifest::GetFullPath(const Record& record)
+{
+	std::filesystem::path recordPath(record.Path);
+
+	if (recordPath.is_absolute())
+	{
+		return recordPath;
+	}
+
+	return std::filesystem::path(InstallPath) / recordPath;
+}
+
+bool InstallManifest::Save()
+{
+	std::lock_guard<std::mutex> lk(ManifestMutex);
+
+	std::string manifestContent;
+	for (auto& [key, record] : Records)
+	{
+		manifestContent += std::format("{}\t{}\t{}\t{}\t{}\n",
+									   NosLib::String::ToString(record.Owner),
+									   NosLib::String::ToString(record.Path),
+									   record.Size,
+									   record.ModifiedTime,
+									   record.Hash);
+	}
+
+	/* write next to the manifest and swap, so a crash mid write doesn't lose it */
+	std::wstring tempPath = GetManifestPath() + L".tmp";
+	{
+		std::ofstream manifestFile(tempPath, std::ios::binary | std::ios::trunc);
+		manifestFile.write(manifestContent.c_str(), manifestContent.size());
+
+		if (!manifestFile.good())
+		{
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tempPath, GetManifestPath(), ec);
+	if (ec)
+	{
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"error: \"{}\" When trying to save install manifest", NosLib::String::ToWstring(ec.message())), NosLib::Logging::Severity::Error);
+		return false;
+	}
+
+	NosLib::Logging::CreateLog<wchar_t>(std::format(L"Saved install manifest with {} files", Records.size()), NosLib::Logging::Severity::Info);
+	return true;
+}
+
+std::wstring InstallManifest::ToManifestPath(const std::filesystem::path& filePath)
+{
+	std::filesystem::path normalizedPath = filePath.lexically_normal();
+	std::filesystem::path relativePath = normalizedPath.lexically_relative(std::filesystem::path(InstallPath).lexically_normal());
+
+	/* outside of the install path, keep it absolute */
+	if (relativePath.empty() || relativePath.native().starts_with(std::filesystem::path(L"..").native()))
+	{
+		return normalizedPath.wstring();
+	}
+
+	return relativePath.wstring();
+}
+
+std::wstring InstallManifest::AsDirectory(const std::wstring& manifestPath)
+{
+	if (!manifestPath.empty() && manifestPath.back() != L'\\' && manifestPath.back() != L'/')
+	{
+		return manifestPath + L"\\";
+	}
+
+	return manifestPath;
+}
+
+std::wstring InstallManifest::ToKey(const std::wstring& manifestPath)
+{
+	std::wstring key = manifestPath;
+	for (wchar_t& character : key)
+	{
+		character = (character == L'/' ? L'\\' : (wchar_t)std::towlower(character));
+	}
+
+	return key;
+}
+
+std::wstring InstallManifest::GetManifestPath()
+{
+	return InstallPath + ManifestName;
+}
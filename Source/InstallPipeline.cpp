@@ -0,0 +1,227 @@
+#include "../Headers/InstallPipeline.hpp"
+
+#include "../Headers/InstallOptions.hpp"
+#include "../Headers/ModProcessorThread.hpp"
+#include "../Headers/ModInfo.hpp"
+#include "../Headers/File.hpp"
+#include "../Headers/InstallEstimator.hpp"
+
+#include <thread>
+
+InstallPipeline::InstallPipeline(NosLib::DynamicArray<ModInfo*>& mods) :
+	Mods(mods),
+	DownloadQueue(InstallOptions::DownloadThreads * 2),
+	ExtractQueue(InstallOptions::ExtractThreads * 2), /* limits how many downloaded archives can be waiting on the disk */
+	InstallQueue(mods.GetItemCount() + 1)
+{}
+
+void InstallPipeline::Run()
+{
+	/* already completed mods (installed before, kept by an update) don't go through again */
+	std::vector<ModInfo*> pendingMods;
+	for (ModInfo* mod : Mods)
+	{
+		if (mod->GetModWorkState() != ModInfo::WorkState::Completed)
+		{
+			pendingMods.push_back(mod);
+		}
+	}
+
+	ModCount = static_cast<int>(pendingMods.size());
+
+	/* a mod gets installed once nothing blocks it: not submitted yet (1), its file (1 if it isn't ready) and every dependency not installed yet */
+	for (ModInfo* mod : pendingMods)
+	{
+		File* fileObject = mod->GetFileObject();
+
+		int blockers = 1;
+		if (fileObject != nullptr)
+		{
+			FileUsers[fileObject].push_back(mod);
+
+			if (!fileObject->CheckIfReady())
+			{
+				blockers++;
+			}
+		}
+
+		mod->SetInstallBlockers(blockers);
+	}
+
+	/* files shared between mods get downloaded and extracted once */
+	int fileCount = 0;
+	for (auto& [fileObject, users] : FileUsers)
+	{
+		if (!fileObject->CheckIfReady())
+		{
+			fileCount++;
+		}
+	}
+	InstallEstimator::Start(fileCount, ModCount);
+
+	/* only dependencies that are part of this run count, they are the only ones which will release their dependents */
+	for (ModInfo* mod : pendingMods)
+	{
+		for (ModInfo* dependent : mod->GetDependents())
+		{
+			dependent->AddInstallBlocker();
+		}
+	}
+
+	if (ModCount == 0)
+	{
+		InstallQueue.Close();
+	}
+
+	ActiveDownloaders = InstallOptions::DownloadThreads;
+	ActiveExtractors = InstallOptions::ExtractThreads;
+
+	std::vector<std::thread> workers;
+	for (int i = 0; i < InstallOptions::DownloadThreads; i++)
+	{
+		workers.emplace_back(&InstallPipeline::DownloadWorker, this);
+	}
+	for (int i = 0; i < InstallOptions::ExtractThreads; i++)
+	{
+		workers.emplace_back(&InstallPipeline::ExtractWorker, this);
+	}
+	for (int i = 0; i < InstallOptions::InstallThreads; i++)
+	{
+		workers.emplace_back(&InstallPipeline::InstallWorker, this);
+	}
+
+	for (ModInfo* mod : pendingMods)
+	{
+		Submit(mod);
+	}
+
+	/* every file has been queued, the download and extract stages close as they drain. The install stage closes after the last mod */
+	DownloadQueue.Close();
+
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+void InstallPipeline::Submit(ModInfo* mod)
+{
+	/* claiming is a single atomic transition, a mod submitted twice (or from 2 threads) only goes through once */
+	if (!mod->TryTransition(ModInfo::WorkState::NotStarted, ModInfo::WorkState::Submitted))
+	{
+		return;
+	}
+
+	File* fileObject = mod->GetFileObject();
+
+	/* first mod to claim the file takes it through download and extract, the rest get released by FileReady */
+	if (fileObject != nullptr && !fileObject->CheckIfReady() && fileObject->TryClaim())
+	{
+		DownloadQueue.Push(mod);
+	}
+
+	/* the mod's own submission blocker, goes last so nothing can release a mod which isn't Submitted yet */
+	ReleaseMod(mod);
+}
+
+void InstallPipeline::FileReady(File* file)
+{
+	/* failed files still go through, the install stage logs them as failed mods */
+	auto fileUsers = FileUsers.find(file);
+	if (fileUsers == FileUsers.end())
+	{
+		return;
+	}
+
+	for (ModInfo* user : fileUsers->second)
+	{
+		ReleaseMod(user);
+	}
+}
+
+void InstallPipeline::ReleaseMod(ModInfo* mod)
+{
+	/* whoever removes the last blocker queues the mod */
+	if (!mod->ReleaseInstallBlocker())
+	{
+		return;
+	}
+
+	if (mod->TryTransition(ModInfo::WorkState::Submitted, ModInfo::WorkState::Ready))
+	{
+		InstallQueue.Push(mod);
+	}
+}
+
+void InstallPipeline::DownloadWorker()
+{
+	ModProcessorThread processingThread;
+
+	ModInfo* mod;
+	while (DownloadQueue.Pop(&mod))
+	{
+		if (mod->DownloadModFile(&processingThread))
+		{
+			ExtractQueue.Push(mod);
+		}
+		else
+		{
+			FileReady(mod->GetFileObject());
+		}
+
+		processingThread.UpdateModProgress(0);
+		processingThread.UpdateModStatus(L"Waiting for Download");
+	}
+
+	/* last downloader out, nothing else will reach the extractors */
+	if (--ActiveDownloaders == 0)
+	{
+		ExtractQueue.Close();
+	}
+}
+
+void InstallPipeline::ExtractWorker()
+{
+	ModProcessorThread processingThread;
+
+	ModInfo* mod;
+	while (ExtractQueue.Pop(&mod))
+	{
+		mod->ExtractModFile(&processingThread);
+		FileReady(mod->GetFileObject());
+
+		processingThread.UpdateModProgress(0);
+		processingThread.UpdateModStatus(L"Waiting for Extraction");
+	}
+
+	--ActiveExtractors;
+}
+
+void InstallPipeline::InstallWorker()
+{
+	ModProcessorThread processingThread;
+
+	ModInfo* mod;
+	while (InstallQueue.Pop(&mod))
+	{
+		mod->ProcessMod(&processingThread);
+
+		/* failed mods release their dependents too, a missing mod shouldn't stop the rest of the install */
+		for (ModInfo* dependent : mod->GetDependents())
+		{
+			ReleaseMod(dependent);
+		}
+
+		int completed = ++CompleteCount;
+		InstallEstimator::ModCompleted();
+
+		/* last mod installed, nothing else will reach the installers */
+		if (completed == ModCount)
+		{
+			InstallQueue.Close();
+		}
+
+		processingThread.UpdateModProgress(0);
+		processingThread.UpdateModStatus(L"Waiting for Install");
+	}
+}
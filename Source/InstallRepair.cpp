@@ -0,0 +1,176 @@
+#include "../Headers/InstallRepair.hpp"
+
+#include "../Headers/InstallManifest.hpp"
+#include "../Headers/InstallOptions.hpp"
+#include "../Headers/ModInfo.hpp"
+#include "../Headers/Hash.hpp"
+
+#include <NosLib/Logging.hpp>
+
+#include <filesystem>
+#include <format>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <chrono>
+
+/* runs work(i) for every i in [0, count) on every core */
+static void parallelFor(const size_t& count, const std::function<void(size_t)>& work)
+{
+	std::atomic<size_t> nextIndex = 0;
+
+	auto worker = [&]()
+	{
+		for (size_t i = nextIndex++; i < count; i = nextIndex++)
+		{
+			work(i);
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (int i = 0; i < InstallOptions::ExtractThreads; i++)
+	{
+		workers.emplace_back(worker);
+	}
+
+	for (std::thread& thread : workers)
+	{
+		thread.join();
+	}
+}
+
+std::unordered_set<std::wstring> InstallRepair::FindDamagedOwners()
+{
+	enum class FileCheck : uint8_t
+	{
+		Intact,
+		Damaged,
+		NeedsHash,
+	};
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<InstallManifest::Record> records = InstallManifest::GetRecords();
+	std::vector<FileCheck> checks(records.size(), FileCheck::Intact);
+
+	/* stat everything first, missing files and size changes are damaged without reading anything */
+	parallelFor(records.size(), [&](size_t i)
+	{
+		std::filesystem::path fullPath = InstallManifest::GetFullPath(records[i]);
+
+		std::error_code ec;
+		uint64_t size = std::filesystem::file_size(fullPath, ec);
+		if (ec || size != records[i].Size)
+		{
+			checks[i] = FileCheck::Damaged;
+			return;
+		}
+
+		int64_t modifiedTime = std::filesystem::last_write_time(fullPath, ec).time_since_epoch().count();
+		if (ec || modifiedTime != records[i].ModifiedTime)
+		{
+			checks[i] = FileCheck::NeedsHash;
+		}
+	});
+
+	std::vector<size_t> hashIndices;
+	for (size_t i = 0; i < checks.size(); i++)
+	{
+		if (checks[i] == FileCheck::NeedsHash)
+		{
+			hashIndices.push_back(i);
+		}
+	}
+
+	/* touched but same size, only the contents can tell */
+	parallelFor(hashIndices.size(), [&](size_t i)
+	{
+		const InstallManifest::Record& record = records[hashIndices[i]];
+
+		std::string hash;
+		bool hashed = XXH64Hasher::HashFile(InstallManifest::GetFullPath(record).wstring(), &hash);
+
+		checks[hashIndices[i]] = ((hashed && hash == record.Hash) ? FileCheck::Intact : FileCheck::Damaged);
+	});
+
+	std::unordered_set<std::wstring> damagedOwners;
+	size_t damagedCount = 0;
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		if (checks[i] == FileCheck::Damaged)
+		{
+			damagedOwners.insert(records[i].Owner);
+			damagedCount++;
+		}
+	}
+
+	auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+	NosLib::Logging::CreateLog<wchar_t>(std::format(L"Verified {} files in {}ms ({} hashed), {} damaged across {} mods",
+													records.size(), elapsed.count(), hashIndices.size(), damagedCount, damagedOwners.size()), NosLib::Logging::Severity::Info);
+
+	return damagedOwners;
+}
+
+std::unordered_set<std::wstring> InstallRepair::AddDependents(NosLib::DynamicArray<ModInfo*>& mods, const std::unordered_set<std::wstring>& damagedOwners)
+{
+	std::unordered_set<std::wstring> reinstallOwners;
+	std::vector<ModInfo*> pending;
+
+	for (ModInfo* mod : mods)
+	{
+		if (damagedOwners.contains(mod->GetOwnerKey()))
+		{
+			reinstallOwners.insert(mod->GetOwnerKey());
+			pending.push_back(mod);
+		}
+	}
+
+	/* dependents install after the mod, and their dependents after them */
+	while (!pending.empty())
+	{
+		ModInfo* mod = pending.back();
+		pending.pop_back();
+
+		for (ModInfo* dependent : mod->GetDependents())
+		{
+			if (reinstallOwners.insert(dependent->GetOwnerKey()).second)
+			{
+				pending.push_back(dependent);
+			}
+		}
+	}
+
+	NosLib::Logging::CreateLog<wchar_t>(std::format(L"{} mods to install again, {} with the mods installed after them", damagedOwners.size(), reinstallOwners.size()), NosLib::Logging::Severity::Info);
+	return reinstallOwners;
+}
+
+void InstallRepair::Apply(NosLib::DynamicArray<ModInfo*>& mods, const std::unordered_set<std::wstring>& damagedOwners)
+{
+	std::unordered_set<std::wstring> installedOwners;
+	for (const InstallManifest::Record& record : InstallManifest::GetRecords())
+	{
+		installedOwners.insert(record.Owner);
+	}
+
+	int repairCount = 0;
+
+	for (ModInfo* mod : mods)
+	{
+		if (mod->GetModWorkState() == ModInfo::WorkState::Completed)
+		{
+			continue;
+		}
+
+		/* never installed (new mod, or a separator which owns no files) or damaged, goes through the pipeline */
+		if (!installedOwners.contains(mod->GetOwnerKey()) || damagedOwners.contains(mod->GetOwnerKey()))
+		{
+			repairCount++;
+			continue;
+		}
+
+		mod->MarkUpToDate();
+	}
+
+	NosLib::Logging::CreateLog<wchar_t>(std::format(L"Repair: reinstalling {} mods", repairCount), NosLib::Logging::Severity::Info);
+}
@@ -0,0 +1,233 @@
+#include "../Headers/LinkScanner.hpp"
+
+#include <NosLib/Logging.hpp>
+
+#include <cctype>
+#include <format>
+
+static std::string toLowerAscii(std::string text)
+{
+	for (char& character : text)
+	{
+		character = static_cast<char>(std::tolower(static_cast<unsigned char>(character)));
+	}
+
+	return text;
+}
+
+/* finds the ">" closing the tag starting at tagStart, skipping ones inside quoted attribute values */
+static size_t findTagEnd(const std::string& text, const size_t& tagStart)
+{
+	char quote = 0;
+	for (size_t i = tagStart + 1; i < text.size(); i++)
+	{
+		if (quote != 0)
+		{
+			if (text[i] == quote)
+			{
+				quote = 0;
+			}
+		}
+		else if (text[i] == '"' || text[i] == '\'')
+		{
+			quote = text[i];
+		}
+		else if (text[i] == '>')
+		{
+			return i;
+		}
+	}
+
+	return std::string::npos;
+}
+
+/* links on ModDB only ever escape "&" */
+static std::string decodeEntities(std::string text)
+{
+	size_t position = 0;
+	while ((position = text.find("&amp;", position)) != std::string::npos)
+	{
+		text.replace(position, 5, "&");
+		position++;
+	}
+
+	return text;
+}
+
+bool LinkScanner::Feed(const char* data, const size_t& length)
+{
+	if (Done)
+	{
+		return false;
+	}
+
+	Pending.append(data, length);
+
+	size_t position = 0;
+	while (!Done)
+	{
+		/* skip over script, style and comments, they can contain anything that looks like a tag */
+		if (!RawTextEnd.empty())
+		{
+			size_t rawEnd = toLowerAscii(Pending.substr(position)).find(RawTextEnd);
+			if (rawEnd == std::string::npos)
+			{
+				/* end marker might be split between chunks */
+				size_t keep = (RawTextEnd.size() - 1 < Pending.size() - position ? RawTextEnd.size() - 1 : Pending.size() - position);
+				position = Pending.size() - keep;
+				break;
+			}
+
+			position += rawEnd + RawTextEnd.size();
+			RawTextEnd.clear();
+			continue;
+		}
+
+		size_t tagStart = Pending.find('<', position);
+		if (tagStart == std::string::npos)
+		{
+			position = Pending.size();
+			break;
+		}
+
+		if (tagStart + 1 >= Pending.size())
+		{
+			position = tagStart;
+			break;
+		}
+
+		/* a "<" in text ("3 < 4") isn't a tag, treating it as one would take the next "'" as an attribute quote and skip the rest of the page */
+		char nameStart = Pending[tagStart + 1];
+		if (!std::isalpha(static_cast<unsigned char>(nameStart)) && nameStart != '/' && nameStart != '!')
+		{
+			position = tagStart + 1;
+			continue;
+		}
+
+		if (Pending.compare(tagStart, 4, "<!--") == 0)
+		{
+			RawTextEnd = "-->";
+			position = tagStart + 4;
+			continue;
+		}
+
+		/* wait for the rest of the tag */
+		if (Pending.size() - tagStart < 4)
+		{
+			position = tagStart;
+			break;
+		}
+
+		size_t tagEnd = findTagEnd(Pending, tagStart);
+		if (tagEnd == std::string::npos)
+		{
+			position = tagStart;
+			break;
+		}
+
+		ProcessTag(Pending.substr(tagStart + 1, tagEnd - tagStart - 1));
+		position = tagEnd + 1;
+	}
+
+	Pending.erase(0, position);
+
+	if (Pending.size() > MaxPendingSize)
+	{
+		NosLib::Logging::CreateLog<char>(std::format("Dropped {} bytes of html with an unclosed tag, links inside it are missed", Pending.size()), NosLib::Logging::Severity::Warning);
+		Pending.clear();
+	}
+
+	return !Done;
+}
+
+void LinkScanner::ProcessTag(const std::string& tag)
+{
+	size_t nameEnd = 0;
+	while (nameEnd < tag.size() && !std::isspace(static_cast<unsigned char>(tag[nameEnd])) && tag[nameEnd] != '/')
+	{
+		nameEnd++;
+	}
+
+	std::string tagName = toLowerAscii(tag.substr(0, nameEnd));
+
+	if (tagName == "script" || tagName == "style")
+	{
+		RawTextEnd = "</" + tagName;
+		return;
+	}
+
+	if (tagName != "a")
+	{
+		return;
+	}
+
+	/* attributes: name, name=value, name="value" or name='value' */
+	std::string href;
+	std::string id;
+	bool hasHref = false;
+
+	size_t position = nameEnd;
+	while (position < tag.size())
+	{
+		while (position < tag.size() && (std::isspace(static_cast<unsigned char>(tag[position])) || tag[position] == '/'))
+		{
+			position++;
+		}
+
+		size_t attributeStart = position;
+		while (position < tag.size() && tag[position] != '=' && !std::isspace(static_cast<unsigned char>(tag[position])) && tag[position] != '/')
+		{
+			position++;
+		}
+
+		std::string attributeName = toLowerAscii(tag.substr(attributeStart, position - attributeStart));
+		std::string attributeValue;
+
+		if (position < tag.size() && tag[position] == '=')
+		{
+			position++;
+
+			if (position < tag.size() && (tag[position] == '"' || tag[position] == '\''))
+			{
+				char quote = tag[position];
+				size_t valueEnd = tag.find(quote, position + 1);
+				valueEnd = (valueEnd == std::string::npos ? tag.size() : valueEnd);
+
+				attributeValue = tag.substr(position + 1, valueEnd - position - 1);
+				position = valueEnd + 1;
+			}
+			else
+			{
+				size_t valueStart = position;
+				while (position < tag.size() && !std::isspace(static_cast<unsigned char>(tag[position])))
+				{
+					position++;
+				}
+
+				attributeValue = tag.substr(valueStart, position - valueStart);
+			}
+		}
+
+		if (attributeName == "href")
+		{
+			href = decodeEntities(attributeValue);
+			hasHref = true;
+		}
+		else if (attributeName == "id")
+		{
+			id = attributeValue;
+		}
+		else if (attributeName.empty())
+		{
+			position++;
+		}
+	}
+
+	if (!hasHref || (!AnchorId.empty() && id != AnchorId))
+	{
+		return;
+	}
+
+	Links.push_back(href);
+	Done = FirstOnly;
+}
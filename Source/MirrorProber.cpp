@@ -0,0 +1,275 @@
+#include "../Headers/MirrorProber.hpp"
+
+#include <NosLib/HttpClient.hpp>
+#include <NosLib/Logging.hpp>
+#include <NosLib/String.hpp>
+
+#include <fstream>
+#include <filesystem>
+#include <sstream>
+#include <format>
+#include <chrono>
+#include <limits>
+#include <cstdlib>
+
+static uint64_t secondsSinceEpoch()
+{
+	return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+double MirrorProber::Score::GetEstimatedSeconds() const
+{
+	if (!Reachable || BytesPerSecond <= 0)
+	{
+		return std::numeric_limits<double>::infinity();
+	}
+
+	return (LatencyMs / 1000.0) + (TypicalArchiveSize / BytesPerSecond);
+}
+
+void MirrorProber::Initialize(const std::wstring& scoresPath)
+{
+	std::lock_guard<std::mutex> lk(ProberMutex);
+
+	ScoresPath = (scoresPath.empty() ? GetDefaultPath() : scoresPath);
+
+	std::error_code ec;
+	std::filesystem::create_directories(std::filesystem::path(ScoresPath).parent_path(), ec);
+
+	LoadScores();
+
+	NosLib::Logging::CreateLog<wchar_t>(std::format(L"Loaded {} mirror scores from \"{}\"", Scores.size(), ScoresPath), NosLib::Logging::Severity::Info);
+}
+
+std::wstring MirrorProber::GetDefaultPath()
+{
+	#ifdef _WIN32
+	wchar_t* localAppData = nullptr;
+	size_t length = 0;
+	if (_wdupenv_s(&localAppData, &length, L"LOCALAPPDATA") == 0 && localAppData != nullptr)
+	{
+		std::wstring path = std::format(L"{}\\NorzkasGammaInstaller\\mirror_scores.txt", localAppData);
+		free(localAppData);
+		return path;
+	}
+	#else
+	const char* home = std::getenv("HOME");
+	if (home != nullptr)
+	{
+		return NosLib::String::ToWstring(std::format("{}/.cache/NorzkasGammaInstaller/mirror_scores.txt", home));
+	}
+	#endif // _WIN32
+
+	return L"mirror_scores.txt";
+}
+
+MirrorProber::Score MirrorProber::GetScore(const Candidate& candidate)
+{
+	std::promise<Score> measurement;
+
+	{
+		std::unique_lock<std::mutex> lk(ProberMutex);
+
+		auto found = Scores.find(candidate.HostUrl);
+		if (found != Scores.end() && secondsSinceEpoch() - found->second.MeasuredAt < ScoreLifetime)
+		{
+			return found->second;
+		}
+
+		/* another mod is measuring the host already */
+		auto inFlight = InFlight.find(candidate.HostUrl);
+		if (inFlight != InFlight.end())
+		{
+			std::shared_future<Score> pending = inFlight->second;
+			lk.unlock();
+			return pending.get();
+		}
+
+		InFlight[candidate.HostUrl] = measurement.get_future().share();
+	}
+
+	/* waiters share this measurement, it has to give them a score even if it fails */
+	Score score;
+	try
+	{
+		score = Measure(candidate);
+	}
+	catch (const std::exception& ex)
+	{
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"Failed to measure mirror \"{}\": {}", NosLib::String::ToWstring(candidate.HostUrl), NosLib::String::ToWstring(ex.what())), NosLib::Logging::Severity::Warning);
+		score = Score();
+		score.MeasuredAt = secondsSinceEpoch();
+	}
+
+	{
+		std::lock_guard<std::mutex> lk(ProberMutex);
+		Scores[candidate.HostUrl] = score;
+		InFlight.erase(candidate.HostUrl);
+
+		if (!ScoresPath.empty())
+		{
+			SaveScores();
+		}
+	}
+
+	measurement.set_value(score);
+	return score;
+}
+
+MirrorProber::Score MirrorProber::Measure(const Candidate& candidate)
+{
+	Score score;
+	score.MeasuredAt = secondsSinceEpoch();
+
+	/* fresh client on purpose, a pooled connection would hide the connect time */
+	NosLib::HttpClient::ptr probeClient = NosLib::HttpClient::MakeClient(candidate.HostUrl);
+	probeClient->set_follow_location(true);
+	probeClient->set_connection_timeout(5, 0);
+	probeClient->set_read_timeout(5, 0);
+
+	httplib::Headers rangeHeader = { {"Range", std::format("bytes=0-{}", SampleBytes - 1)} };
+
+	std::chrono::steady_clock::time_point requestStart = std::chrono::steady_clock::now();
+	std::chrono::steady_clock::time_point sampleStart;
+	uint64_t sampledBytes = 0;
+
+	httplib::Result res = probeClient->Get(candidate.SamplePath, rangeHeader,
+										   [&](const httplib::Response& response)
+	{
+		sampleStart = std::chrono::steady_clock::now();
+		return response.status == 200 || response.status == 206;
+	},
+										   [&](const char* data, size_t data_length)
+	{
+		sampledBytes += data_length;
+
+		uint64_t sampleMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - sampleStart).count();
+
+		/* enough to judge it (servers ignoring the range would otherwise send the entire file) */
+		return sampledBytes < SampleBytes && sampleMs < SampleTimeLimitMs;
+	});
+
+	if (sampledBytes == 0)
+	{
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"Mirror \"{}\" didn't respond ({})", NosLib::String::ToWstring(candidate.HostUrl), NosLib::String::ToWstring(httplib::to_string(res.error()))), NosLib::Logging::Severity::Debug);
+		return score;
+	}
+
+	std::chrono::steady_clock::time_point sampleEnd = std::chrono::steady_clock::now();
+	double sampleSeconds = std::chrono::duration<double>(sampleEnd - sampleStart).count();
+
+	score.Reachable = true;
+	score.LatencyMs = std::chrono::duration<double, std::milli>(sampleStart - requestStart).count();
+	score.BytesPerSecond = sampledBytes / (sampleSeconds > 0.001 ? sampleSeconds : 0.001);
+
+	NosLib::Logging::CreateLog<wchar_t>(std::format(L"Mirror \"{}\" latency: {:.0f}ms | throughput: {:.2f}MB/s", NosLib::String::ToWstring(candidate.HostUrl), score.LatencyMs, score.BytesPerSecond / (1024 * 1024)), NosLib::Logging::Severity::Debug);
+	return score;
+}
+
+int MirrorProber::PickFastest(const std::vector<Candidate>& candidates)
+{
+	std::vector<std::future<Score>> futures;
+
+	for (const Candidate& candidate : candidates)
+	{
+		futures.emplace_back(std::async(std::launch::async, [&candidate]() { return GetScore(candidate); }));
+	}
+
+	int fastestIndex = -1;
+	double fastestSeconds = std::numeric_limits<double>::infinity();
+	for (int i = 0; i < futures.size(); i++)
+	{
+		double estimatedSeconds = futures[i].get().GetEstimatedSeconds();
+
+		if (estimatedSeconds < fastestSeconds)
+		{
+			fastestSeconds = estimatedSeconds;
+			fastestIndex = i;
+		}
+	}
+
+	return fastestIndex;
+}
+
+void MirrorProber::LoadScores()
+{
+	Scores.clear();
+
+	std::ifstream scoresFile(ScoresPath, std::ios::binary);
+	if (!scoresFile.is_open())
+	{
+		return;
+	}
+
+	/* one host per line, tab separated: host url, latency, bytes per second, measured at */
+	std::string line;
+	while (std::getline(scoresFile, line))
+	{
+		std::vector<std::string> fields;
+		std::istringstream lineStream(line);
+		std::string field;
+		while (std::getline(lineStream, field, '\t'))
+		{
+			fields.push_back(field);
+		}
+
+		if (fields.size() != 4)
+		{
+			continue;
+		}
+
+		Score score;
+		score.Reachable = true;
+
+		/* damaged line, that host just gets measured again */
+		try
+		{
+			score.LatencyMs = std::stod(fields[1]);
+			score.BytesPerSecond = std::stod(fields[2]);
+			score.MeasuredAt = std::stoull(fields[3]);
+		}
+		catch (const std::exception&)
+		{
+			continue;
+		}
+
+		Scores[fields[0]] = score;
+	}
+}
+
+bool MirrorProber::SaveScores()
+{
+	std::string scoresContent;
+	for (auto& [hostUrl, score] : Scores)
+	{
+		/* unreachable is usually temporary, only kept for this session */
+		if (!score.Reachable)
+		{
+			continue;
+		}
+
+		scoresContent += std::format("{}\t{}\t{}\t{}\n", hostUrl, score.LatencyMs, score.BytesPerSecond, score.MeasuredAt);
+	}
+
+	/* write next to the scores and swap, so a crash mid write doesn't leave a broken file behind */
+	std::wstring tempPath = ScoresPath + L".tmp";
+	{
+		std::ofstream scoresFile(tempPath, std::ios::binary | std::ios::trunc);
+		scoresFile.write(scoresContent.c_str(), scoresContent.size());
+
+		if (!scoresFile.good())
+		{
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tempPath, ScoresPath, ec);
+	if (ec)
+	{
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"error: \"{}\" When trying to save mirror scores", NosLib::String::ToWstring(ec.message())), NosLib::Logging::Severity::Error);
+		return false;
+	}
+
+	return true;
+}
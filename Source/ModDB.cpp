@@ -1,181 +1,202 @@
 #include <NosLib/Logging.hpp>
-#include <html.hpp>
 
 #include "../Headers/ModDB.hpp"
+#include "../Headers/LinkScanner.hpp"
+#include "../Headers/MirrorProber.hpp"
+#include "../Headers/HostGovernor.hpp"
 
-#include <future>
 #include <vector>
-
-#include <IPExport.h>
-#include <icmpapi.h>
-#include <WinSock2.h>
-#include <Ws2tcpip.h>
-
-#pragma comment(lib, "iphlpapi.lib")
-#pragma comment(lib, "ws2_32.lib")
+#include <chrono>
 
 std::wstring ModDB::GetGivenMirror(const std::wstring& downloadLink)
 {
-	std::string pageContent = GetPageContent(NosLib::String::ToString(downloadLink));
+	/* the mirror link is the first link on the page */
+	LinkScanner scanner;
 
-	if (pageContent.empty())
+	if (!ScanPage(NosLib::String::ToString(downloadLink), &scanner) || scanner.GetLinks().empty())
 	{
 		return L"";
 	}
 
-	html::parser p;
-	html::node_ptr node = p.parse(pageContent);
-
-	std::vector<html::node*> mirrorContainers = node->select("a[href]");
-
-	if (mirrorContainers.size() < 1)
-	{
-		return L"";
-	}
-
-	return NosLib::String::ToWstring(mirrorContainers[0]->get_attr("href"));
+	return NosLib::String::ToWstring(scanner.GetLinks()[0]);
 }
 
 std::wstring ModDB::GetQuickestMirror(const std::wstring& downloadLink)
 {
-	std::string pageContent = GetPageContent(NosLib::String::ToString(downloadLink) + "/all");
-	
-	if (pageContent.empty())
+	LinkScanner scanner("downloadon", false);
+
+	if (!ScanPage(NosLib::String::ToString(downloadLink) + "/all", &scanner))
 	{
 		return L"";
 	}
 
-	NosLib::DynamicArray<std::string> mirrors = ExtractMirrors(pageContent);
-	std::vector<std::future<uint32_t>> futures;
+	const std::vector<std::string>& mirrors = scanner.GetLinks();
 
-	for (const std::string& mirror : mirrors)
+	if (mirrors.empty())
 	{
-		futures.emplace_back(std::async(std::launch::async,
-								  [this](const std::string& mirrorHostname) { return PingMirror(mirrorHostname); },
-								  std::cref(mirror)));
+		return L"";
 	}
 
-	int quickestIndex = 0;
-	uint32_t quickestTime = -1; /* underflow to max */
-	for (int i = 0; i < futures.size(); i++)
+	/* the mirror links point at ModDB, which redirects to the actual file on the mirror host */
+	std::vector<MirrorProber::Candidate> candidates;
+	std::vector<int> candidateMirrors;
+	for (int i = 0; i < mirrors.size(); i++)
 	{
-		uint32_t currentTime = futures[i].get();
-
-		if (currentTime < quickestTime)
+		MirrorProber::Candidate candidate;
+		if (!ResolveMirror(mirrors[i], &candidate.HostUrl, &candidate.SamplePath))
 		{
-			quickestTime = currentTime;
-			quickestIndex = i;
+			continue;
 		}
-	}
-
-	NosLib::Logging::CreateLog<char>(std::format("Quickest Mirror was: {} | ping time: {}ms", quickestIndex, quickestTime), NosLib::Logging::Severity::Debug);
 
-	return NosLib::String::ToWstring(mirrors[quickestIndex]);
-}
+		candidates.push_back(candidate);
+		candidateMirrors.push_back(i);
+	}
 
-std::string ModDB::GetPageContent(const std::string& downloadLink)
-{
-	httplib::Result modDBResult = ModDBMirrorClient->Get(downloadLink );
+	int fastestCandidate = MirrorProber::PickFastest(candidates);
 
-	if (modDBResult->status == 503)
+	/* nothing could be measured, the first mirror is as good as any */
+	if (fastestCandidate == -1)
 	{
-		NosLib::Logging::CreateLog<char>("ModDB currently Unavailable, most likely too many requests", NosLib::Logging::Severity::Error);
-		return "";
+		return NosLib::String::ToWstring(mirrors[0]);
 	}
 
-	if (modDBResult->status != 200)
-	{
-		NosLib::Logging::CreateLog<char>(std::format("File not found. Status: {} | Reason: \"{}\"", modDBResult->status, modDBResult->reason), NosLib::Logging::Severity::Error);
-		return "";
-	}
+	NosLib::Logging::CreateLog<char>(std::format("Quickest Mirror was: {}", candidates[fastestCandidate].HostUrl), NosLib::Logging::Severity::Debug);
 
-	return modDBResult->body;
+	return NosLib::String::ToWstring(mirrors[candidateMirrors[fastestCandidate]]);
 }
 
-NosLib::DynamicArray<std::string> ModDB::ExtractMirrors(const std::string& pageContent)
+int ModDB::GovernedRequest(const std::string& path, const std::function<int(httplib::Client*)>& request)
 {
-	NosLib::DynamicArray<std::string> out;
+	for (int attempt = 0;; attempt++)
+	{
+		int status;
+		HostGovernor::Outcome outcome;
 
-	html::parser p;
-	html::node_ptr node = p.parse(pageContent);
+		{
+			std::unique_ptr<HostGovernor::Permit> permit = HostGovernor::Acquire(HostUrl);
 
-	std::vector<html::node*> mirrorContainers = node->select("a#downloadon");
+			/* own client per request, a shared client only runs 1 request at a time */
+			ConnectionPool::Lease client = ConnectionPool::Acquire(HostUrl, false);
+			status = request(client.get());
 
-	for (html::node* entry : mirrorContainers)
-	{
-		out.Append(entry->get_attr("href"));
-	}
+			outcome = HostGovernor::Classify(status);
+			permit->Report(outcome);
+		}
 
-	return out;
+		if (outcome != HostGovernor::Outcome::Throttled || attempt + 1 >= HostGovernor::RetryAttempts)
+		{
+			return status;
+		}
+
+		NosLib::Logging::CreateLog<char>(std::format("ModDB is throttling, retrying \"{}\" ({} of {})", path, attempt + 1, HostGovernor::RetryAttempts), NosLib::Logging::Severity::Warning);
+		HostGovernor::WaitBeforeRetry(attempt);
+	}
 }
 
-uint32_t ModDB::PingMirror(const std::string& mirrorHostname)
+httplib::Result ModDB::GovernedGet(const std::string& path)
 {
-	httplib::Result res = ModDBMirrorClient->Get(mirrorHostname);
-
-	httplib::Headers::const_iterator itr = res->headers.find("location");
-	std::string hostnameString = GetHostName(itr->second);
+	httplib::Result res;
 
-	// Create the ICMP context.
-	HANDLE icmp_handle = IcmpCreateFile();
-	if (icmp_handle == INVALID_HANDLE_VALUE)
+	GovernedRequest(path, [&](httplib::Client* client)
 	{
-		throw;
-	}
+		res = client->Get(path);
+		return (res ? res->status : 0);
+	});
 
-	addrinfo* addr = nullptr;
+	return res;
+}
 
-	/* Get IP Address */
-	int errorStatus = getaddrinfo(hostnameString.c_str(), NULL, NULL, &addr);
-	if (errorStatus != 0)
-	{
-		throw;
-	}
+bool ModDB::ScanPage(const std::string& downloadLink, LinkScanner* scanner)
+{
+	/* a retry has to start from an empty scanner again */
+	LinkScanner emptyScanner = *scanner;
 
-	sockaddr_in* destAddr_ipv4 = reinterpret_cast<sockaddr_in*>(addr->ai_addr);
+	/* how much of the page had to be read, and how long the scanning itself took (excluding the network) */
+	uint64_t scannedBytes = 0;
+	std::chrono::steady_clock::duration scanTime{};
 
-	// Payload to send.
-	constexpr WORD payload_size = 1;
-	unsigned char payload[payload_size]{ 42 };
+	int status = GovernedRequest(downloadLink, [&](httplib::Client* client)
+	{
+		*scanner = emptyScanner;
+		scannedBytes = 0;
+		scanTime = {};
+		int responseStatus = 0;
+
+		/* body gets scanned as it arrives, once the scanner has its links the connection is dropped instead of downloading the rest */
+		client->Get(downloadLink,
+					[&](const httplib::Response& response)
+		{
+			responseStatus = response.status;
+			return responseStatus == 200;
+		},
+					[&](const char* data, size_t data_length)
+		{
+			std::chrono::steady_clock::time_point feedStart = std::chrono::steady_clock::now();
+			bool wantsMore = scanner->Feed(data, data_length);
+			scanTime += std::chrono::steady_clock::now() - feedStart;
+			scannedBytes += data_length;
 
-	// Reply buffer for exactly 1 echo reply, payload data, and 8 bytes for ICMP error message.
-	constexpr DWORD reply_buf_size = sizeof(ICMP_ECHO_REPLY) + payload_size + 8;
-	unsigned char reply_buf[reply_buf_size]{};
+			return wantsMore;
+		});
 
-	IcmpSendEcho(icmp_handle,
-				 destAddr_ipv4->sin_addr.S_un.S_addr,
-				 payload,
-				 payload_size,
-				 NULL,
-				 reply_buf,
-				 reply_buf_size,
-				 1000);
+		return responseStatus;
+	});
 
-	const ICMP_ECHO_REPLY* reply = (const ICMP_ECHO_REPLY*)reply_buf;
+	if (status == 0)
+	{
+		NosLib::Logging::CreateLog<char>(std::format("Unable to reach ModDB for \"{}\"", downloadLink), NosLib::Logging::Severity::Error);
+		return false;
+	}
 
-	if (reply->Status != IP_SUCCESS)
+	if (status == 503 || status == 429)
 	{
-		NosLib::Logging::CreateLog<char>(std::format("Mirror \"{}\" failed ping", hostnameString, reply->RoundTripTime), NosLib::Logging::Severity::Debug);
-		return -1;
+		NosLib::Logging::CreateLog<char>("ModDB currently Unavailable, most likely too many requests", NosLib::Logging::Severity::Error);
+		return false;
 	}
 
-	NosLib::Logging::CreateLog<char>(std::format("Mirror \"{}\" ping time: {}ms", hostnameString, reply->RoundTripTime), NosLib::Logging::Severity::Debug);
+	if (status != 200)
+	{
+		NosLib::Logging::CreateLog<char>(std::format("File not found. Status: {}", status), NosLib::Logging::Severity::Error);
+		return false;
+	}
 
-	IcmpCloseHandle(icmp_handle);
-	return reply->RoundTripTime;
+	NosLib::Logging::CreateLog<char>(std::format("Scanned {}KB of \"{}\" in {}us, {} links",
+												 scannedBytes / 1024,
+												 downloadLink,
+												 std::chrono::duration_cast<std::chrono::microseconds>(scanTime).count(),
+												 scanner->GetLinks().size()),
+									 NosLib::Logging::Severity::Debug);
+	return true;
 }
 
-std::string ModDB::GetHostName(const std::string& downloadLink)
+bool ModDB::ResolveMirror(const std::string& mirrorLink, std::string* hostUrl, std::string* filePath)
 {
-	size_t position = downloadLink.find("//");
+	httplib::Result res = GovernedGet(mirrorLink);
 
-	std::string out = downloadLink.substr(position +2);
+	if (!res)
+	{
+		NosLib::Logging::CreateLog<char>(std::format("Unable to resolve mirror \"{}\" ({})", mirrorLink, httplib::to_string(res.error())), NosLib::Logging::Severity::Debug);
+		return false;
+	}
 
-	position = out.find('/');
+	httplib::Headers::const_iterator itr = res->headers.find("location");
+	if (itr == res->headers.end())
+	{
+		return false;
+	}
 
-	out = out.substr(0, position);
+	/* split "https://host/path" into the host url and the path */
+	std::string location = itr->second;
+	size_t schemeEnd = location.find("//");
+	if (schemeEnd == std::string::npos)
+	{
+		return false;
+	}
 
-	NosLib::Logging::CreateLog<char>(std::format("mirror hostname: {}", out), NosLib::Logging::Severity::Debug);
+	size_t pathStart = location.find('/', schemeEnd + 2);
+	*hostUrl = location.substr(0, pathStart);
+	*filePath = (pathStart == std::string::npos ? "/" : location.substr(pathStart));
 
-	return out;
-}
\ No newline at end of file
+	NosLib::Logging::CreateLog<char>(std::format("mirror host: {}", *hostUrl), NosLib::Logging::Severity::Debug);
+	return true;
+}
@@ -3,8 +3,10 @@
 #include "../Headers/InstallOptions.hpp"
 #include "../Headers/InstallManager.hpp"
 #include "../Headers/ModProcessorThread.hpp"
+#include "../Headers/TreeCopier.hpp"
+#include "../Headers/Hash.hpp"
 
-void copyIfExists(const std::wstring& from, const std::wstring& to)
+static void copyIfExists(const std::wstring& from, const std::wstring& to, const std::wstring& owner)
 {
 	/* if DOESN'T exist, go to next path (this is to remove 1 layer of nesting) */
 	if (!std::filesystem::exists(from))
@@ -14,7 +16,7 @@ void copyIfExists(const std::wstring& from, const std::wstring& to)
 
 	/* if it does exist, copy the directory with all the subdirectories and folders */
 	std::filesystem::create_directories(to);
-	std::filesystem::copy(from, to, std::filesystem::copy_options::recursive | std::filesystem::copy_options::overwrite_existing);
+	TreeCopier::InstallTree(from, to, true, owner);
 }
 #pragma region constructors
 /// <summary>
@@ -51,6 +53,7 @@ ModInfo::ModInfo(const std::wstring& link, NosLib::DynamicArray<std::wstring>& i
 	ModType = Type::Standard;
 
 	FileObject = File::RegisterFile(link, outName);
+	RegisterExtractPaths();
 }
 
 /// <summary>
@@ -70,6 +73,7 @@ ModInfo::ModInfo(const std::wstring& link, NosLib::DynamicArray<std::wstring>& i
 	ModType = Type::Custom;
 
 	FileObject = File::RegisterFile(link, outName, customExtension);
+	RegisterExtractPaths();
 
 	UseInstallPath = useInstallPath;
 }
@@ -91,11 +95,72 @@ ModInfo::ModInfo(const std::wstring& link, NosLib::DynamicArray<std::wstring>&&
 	ModType = Type::Custom;
 
 	FileObject = File::RegisterFile(link, outName, customExtension);
+	RegisterExtractPaths();
 
 	UseInstallPath = useInstallPath;
 }
 #pragma endregion
 
+std::vector<File::ExtractTarget> ModInfo::GetExtractTargets()
+{
+	/* mirrors what StandardModProcess and CustomModProcess copy out of the extracted archive */
+	std::vector<File::ExtractTarget> targets;
+	for (std::wstring path : InsidePaths)
+	{
+		if (ModType == Type::Standard)
+		{
+			std::wstring rootTo = (InstallOptions::GammaInstallPath + InstallInfo::ModDirectory + GetFolderName() + L"\\");
+
+			/* root files (readme/extra info) and the stalker sub directories */
+			targets.push_back({ path, false, rootTo });
+
+			for (std::wstring subdirectory : ModSubDirectories)
+			{
+				targets.push_back({ path + subdirectory, true, rootTo + subdirectory });
+			}
+		}
+		else
+		{
+			targets.push_back({ path, true, (UseInstallPath ? InstallOptions::GammaInstallPath : L"") + OutPath });
+		}
+	}
+
+	return targets;
+}
+
+void ModInfo::RegisterExtractPaths()
+{
+	for (const File::ExtractTarget& target : GetExtractTargets())
+	{
+		FileObject->AddExtractPath(target.InsidePath, target.Recursive);
+	}
+}
+
+bool ModInfo::InstallDirect()
+{
+	UpdateLoadingScreen(L"Installing files...");
+
+	std::vector<File::ExtractTarget> targets = GetExtractTargets();
+
+	/* the folders get created even if the archive has nothing for them, same as copying */
+	for (const File::ExtractTarget& target : targets)
+	{
+		if (ModType != Type::Standard || !target.Recursive)
+		{
+			std::filesystem::create_directories(target.Destination);
+		}
+	}
+
+	if (!FileObject->InstallDirect(this, &ModInfo::ProgressCallback, targets, GetOwnerKey()))
+	{
+		LogError(L"Failed to install files straight from the archive", std::source_location::current());
+		return false;
+	}
+
+	UpdateLoadingScreen(L"Finished Installing");
+	return true;
+}
+
 std::wstring ModInfo::GetFolderName()
 {
 	switch (ModType)
@@ -114,64 +179,49 @@ std::wstring ModInfo::GetFolderName()
 	}
 }
 
-ModInfo* ModInfo::AddMod(const std::wstring& link, NosLib::DynamicArray<std::wstring>& insidePaths, const std::wstring& outPath, const std::wstring& outName, const bool& priorityInstall, const bool& useInstallPath, const std::wstring& customExtension)
+std::wstring ModInfo::GetOwnerKey()
 {
-	ModInfo* newMod = new ModInfo(link, insidePaths, outPath, outName, useInstallPath, customExtension);
-	ModInfo::ModInfoList.Append(newMod);
-	if (priorityInstall)
+	/* modpack maker mods are identified by their line, custom mods by where they copy from and to */
+	std::wstring identity = UpdateKey;
+	if (identity.empty())
 	{
-		ModInfo::PriorityModList.Append(newMod);
+		identity = OutPath;
+		for (std::wstring path : InsidePaths)
+		{
+			identity += L"\t" + path;
+		}
 	}
-	return newMod;
+
+	XXH64Hasher hasher;
+	hasher.Update(identity.data(), identity.size() * sizeof(wchar_t));
+	return std::format(L"{} [{}]", OutName, NosLib::String::ToWstring(hasher.HexDigest()));
 }
 
-ModInfo* ModInfo::AddMod(const std::wstring& link, NosLib::DynamicArray<std::wstring>&& insidePaths, const std::wstring& outPath, const std::wstring& outName, const bool& priorityInstall, const bool& useInstallPath, const std::wstring& customExtension)
+ModInfo* ModInfo::AddMod(const std::wstring& link, NosLib::DynamicArray<std::wstring>& insidePaths, const std::wstring& outPath, const std::wstring& outName, NosLib::DynamicArray<ModInfo*> dependencies, const bool& useInstallPath, const std::wstring& customExtension)
 {
 	ModInfo* newMod = new ModInfo(link, insidePaths, outPath, outName, useInstallPath, customExtension);
 	ModInfo::ModInfoList.Append(newMod);
-	if (priorityInstall)
+	for (ModInfo* dependency : dependencies)
 	{
-		ModInfo::PriorityModList.Append(newMod);
+		newMod->DependsOn(dependency);
 	}
 	return newMod;
 }
 
-ModInfo::WorkState ModInfo::GetModWorkState()
+ModInfo* ModInfo::AddMod(const std::wstring& link, NosLib::DynamicArray<std::wstring>&& insidePaths, const std::wstring& outPath, const std::wstring& outName, NosLib::DynamicArray<ModInfo*> dependencies, const bool& useInstallPath, const std::wstring& customExtension)
 {
-	std::lock_guard<std::mutex> lk(WorkStateMutex);
-
-	/* If Started, return as inProgress too */
-	if (FileObject != nullptr)
+	ModInfo* newMod = new ModInfo(link, insidePaths, outPath, outName, useInstallPath, customExtension);
+	ModInfo::ModInfoList.Append(newMod);
+	for (ModInfo* dependency : dependencies)
 	{
-		if (FileObject->CheckIfStarted())
-		{
-			WorkState::InProgress;
-		}
+		newMod->DependsOn(dependency);
 	}
-
-	return CurrentWorkState.load();
+	return newMod;
 }
 
-void ModInfo::WaitPriority(ModProcessorThread* processingThread)
+void ModInfo::DependsOn(ModInfo* dependency)
 {
-	if(PriorityModList.GetItemCount() == 0)
-	{ 
-		return;
-	}
-
-	if (PriorityModList[0] == this)
-	{
-		return;
-	}
-
-	ProcessingThread = processingThread;
-	UpdateLoadingScreen(L"Waiting for Priority");
-
-	std::unique_lock<std::mutex> lockGuard(PriorityMutex);
-	PriorityCV.wait(lockGuard, [this]()
-	{
-		return PriorityModList.GetItemCount() == 0 || PriorityModList[0] == this;
-	});
+	dependency->Dependents.Append(this);
 }
 
 void ModInfo::ProcessMod(ModProcessorThread* processingThread)
@@ -201,19 +251,68 @@ void ModInfo::ProcessMod(ModProcessorThread* processingThread)
 
 	if (FileObject != nullptr)
 	{
-		FileObject->Finished();
-		FileObject = nullptr;
+		InstalledVersion = FileObject->GetVersion();
 	}
 
+	ReleaseFile();
+
 	CurrentWorkState = WorkState::Completed;
 	processingThread = nullptr;
+}
+
+void ModInfo::MarkUpToDate()
+{
+	ReleaseFile();
+	CurrentWorkState = WorkState::Completed;
+}
+
+void ModInfo::ReleaseFile()
+{
+	if (FileObject != nullptr)
+	{
+		FileObject->Finished();
+		FileObject = nullptr;
+	}
+}
+
+bool ModInfo::DownloadModFile(ModProcessorThread* processingThread)
+{
+	ProcessingThread = processingThread;
+
+	if (FileObject == nullptr)
+	{
+		return true;
+	}
+
+	UpdateLoadingScreen(0, L"Requesting File...");
+	bool downloaded = FileObject->Download(this, &ModInfo::InitialResponseCallback, &ModInfo::ProgressCallback);
 
-	if (!PriorityModList.GetItemCount() == 0 && PriorityModList[0] == this)
+	if (!downloaded)
 	{
-		PriorityModList.Remove(0);
+		LogError(L"Failed to Download Mod File", std::source_location::current());
 	}
 
-	PriorityCV.notify_all();
+	return downloaded;
+}
+
+bool ModInfo::ExtractModFile(ModProcessorThread* processingThread)
+{
+	ProcessingThread = processingThread;
+
+	if (FileObject == nullptr)
+	{
+		return true;
+	}
+
+	UpdateLoadingScreen(0, L"Waiting to Extract...");
+	bool extracted = FileObject->Extract(this, &ModInfo::InitialResponseCallback, &ModInfo::ProgressCallback);
+
+	if (!extracted)
+	{
+		LogError(L"Failed to Extract Mod File", std::source_location::current());
+	}
+
+	return extracted;
 }
 
 #pragma region Parsing
@@ -221,9 +320,12 @@ void ModInfo::ProcessMod(ModProcessorThread* processingThread)
 /// takes in a filename for a modpackMaker and parses it fully
 /// </summary>
 /// <param name="modpackMakerFileName">(default = "modpack_maker_list.txt") - path/name of modpack Maker</param>
+/// <param name="dependencies">- mods that every parsed mod needs installed first</param>
 /// <returns>a DynamicArray of ModInfo pointers (ModInfo*)</returns>
-void ModInfo::ModpackMakerFile_Parse(const std::wstring& modpackMakerFileName)
+NosLib::DynamicArray<ModInfo*> ModInfo::ModpackMakerFile_Parse(const std::wstring& modpackMakerFileName, NosLib::DynamicArray<ModInfo*> dependencies)
 {
+	NosLib::DynamicArray<ModInfo*> parsedMods;
+
 	/* open binary file stream of modpack maker list */
 	std::wifstream modMakerFile(modpackMakerFileName, std::ios::binary);
 
@@ -231,9 +333,19 @@ void ModInfo::ModpackMakerFile_Parse(const std::wstring& modpackMakerFileName)
 	std::wstring line;
 	while (std::getline(modMakerFile, line))
 	{
+		ModInfo* parsedMod = ParseLine(line);
+
+		for (ModInfo* dependency : dependencies)
+		{
+			parsedMod->DependsOn(dependency);
+		}
+
 		/* append to array */
-		ModInfoList.Append(ParseLine(line));
+		ModInfoList.Append(parsedMod);
+		parsedMods.Append(parsedMod);
 	}
+
+	return parsedMods;
 }
 
 /// <summary>
@@ -243,56 +355,98 @@ void ModInfo::ModpackMakerFile_Parse(const std::wstring& modpackMakerFileName)
 /// <returns>pointer of ModInfo, containing parsed mod info</returns>
 ModInfo* ModInfo::ParseLine(std::wstring& line)
 {
-	/* create array, the file uses \t to separate info */
 	NosLib::DynamicArray<std::wstring> wordArray(6, 2);
+	NosLib::DynamicArray<std::wstring> pathArray(5, 5);
+
+	ModInfo* parsedMod;
+
+	/* if there is only 1 object, that means its a separator, use a different constructor */
+	if (!SplitLine(line, &wordArray, &pathArray))
+	{
+		parsedMod = new ModInfo(wordArray[0]);
+		parsedMod->UpdateKey = MakeUpdateKey(wordArray, pathArray, true);
+		return parsedMod;
+	}
+
+	/* finally, if it has gotten here, it means the current line is a normal mod, pass in all the info to the constructor */
+	parsedMod = new ModInfo(wordArray[0], pathArray, wordArray[2], wordArray[3], wordArray[4]);
+	parsedMod->UpdateKey = MakeUpdateKey(wordArray, pathArray, false);
+	return parsedMod;
+}
 
-	/* split the line into the previous array */
-	NosLib::String::Split<wchar_t>(&wordArray, line, '\t');
+/// <summary>
+/// splits a modpack maker line into its info and inner paths
+/// </summary>
+/// <param name="line">- input line</param>
+/// <param name="wordArray">- gets the tab separated info</param>
+/// <param name="pathArray">- gets the inner paths, normalized (always start and end with "\\", root always included)</param>
+/// <returns>false if the line is a separator (only has a name)</returns>
+bool ModInfo::SplitLine(std::wstring& line, NosLib::DynamicArray<std::wstring>* wordArray, NosLib::DynamicArray<std::wstring>* pathArray)
+{
+	/* split the line, the file uses \t to separate info */
+	NosLib::String::Split<wchar_t>(wordArray, line, '\t');
 
 	/* go through all strings in the array and "reduce" them (take out spaces in front, behind and any duplicate spaces inbetween) */
-	for (int i = 0; i <= wordArray.GetLastArrayIndex(); i++)
+	for (int i = 0; i <= wordArray->GetLastArrayIndex(); i++)
 	{
-		wordArray[i] = NosLib::String::Reduce(wordArray[i]);
+		(*wordArray)[i] = NosLib::String::Reduce((*wordArray)[i]);
 	}
 
-	/* if there is only 1 object (so last index is 0), that means its a separator, use a different constructor */
-	if (wordArray.GetLastArrayIndex() == 0)
+	/* if there is only 1 object (so last index is 0), that means its a separator */
+	if (wordArray->GetLastArrayIndex() == 0)
 	{
-		return new ModInfo(wordArray[0]);
+		return false;
 	}
 
 	/* some mods have multiple inner paths that get combined, separate them into an array for easier processing */
-	NosLib::DynamicArray<std::wstring> pathArray(5, 5);
-	NosLib::String::Split<wchar_t>(&pathArray, wordArray[1], ':');
+	NosLib::String::Split<wchar_t>(pathArray, (*wordArray)[1], ':');
 
 	bool hasRoot = false;
 
 	/* go through all path strings in the array, and if any are equal to 0, that means it is root */
-	for (int i = 0; i <= pathArray.GetLastArrayIndex(); i++)
+	for (int i = 0; i <= pathArray->GetLastArrayIndex(); i++)
 	{
-		if (pathArray[i] == L"0" || pathArray[i] == L"\\")
+		std::wstring& path = (*pathArray)[i];
+
+		if (path == L"0" || path == L"\\")
 		{
-			pathArray[i] = L"\\";
+			path = L"\\";
 			hasRoot = true;
 		}
-		else if (pathArray[i][0] != L'\\')
+		else if (path[0] != L'\\')
 		{
-			pathArray[i].insert(0, L"\\");
+			path.insert(0, L"\\");
 		}
 
-		if (pathArray[i].back() != L'\\')
+		if (path.back() != L'\\')
 		{
-			pathArray[i].append(L"\\");
+			path.append(L"\\");
 		}
 	}
 
 	if (!hasRoot)
 	{
-		pathArray.Insert(L"\\", 0);
+		pathArray->Insert(L"\\", 0);
 	}
 
-	/* finally, if it has gotten here, it means the current line is a normal mod, pass in all the info to the constructor */
-	return new ModInfo(wordArray[0], pathArray, wordArray[2], wordArray[3], wordArray[4]);
+	return true;
+}
+
+std::wstring ModInfo::MakeUpdateKey(NosLib::DynamicArray<std::wstring>& wordArray, NosLib::DynamicArray<std::wstring>& pathArray, const bool& separator)
+{
+	if (separator)
+	{
+		return std::format(L"separator\t{}", wordArray[0]);
+	}
+
+	/* link, inner paths, creator and name. The original link is only informational, it doesn't change what gets installed */
+	std::wstring paths;
+	for (std::wstring path : pathArray)
+	{
+		paths += path + L":";
+	}
+
+	return std::format(L"{}\t{}\t{}\t{}", wordArray[0], paths, wordArray[2], wordArray[3]);
 }
 #pragma endregion
 
@@ -320,6 +474,18 @@ void ModInfo::UpdateLoadingScreen(const int& percentageOnCurrentMod)
 	instance->UpdateModProgress(percentageOnCurrentMod);
 }
 
+void ModInfo::UpdateLoadingScreen(const uint64_t& done, const uint64_t& total)
+{
+	if (ProcessingThread != nullptr)
+	{
+		ProcessingThread->UpdateModProgress(done, total);
+		return;
+	}
+
+	InstallManager* instance = InstallManager::GetInstallManager();
+	instance->UpdateModProgress(done, total);
+}
+
 void ModInfo::UpdateLoadingScreen(const int& percentageOnCurrentMod, const std::wstring& status)
 {
 	UpdateLoadingScreen(percentageOnCurrentMod);
@@ -339,6 +505,7 @@ void ModInfo::LogError(const std::wstring& errorMessage, const std::source_locat
 											errorMessage);
 
 	NosLib::Logging::CreateLog<wchar_t>(logMessage, NosLib::Logging::Severity::Error);
+	InstallFailed = true;
 }
 
 void ModInfo::StandardModProcess()
@@ -352,6 +519,13 @@ void ModInfo::StandardModProcess()
 		LogError(L"Failed to Get Mod File", std::source_location::current());
 	}
 
+	/* archive was never extracted, write the files straight into place */
+	if (FileObject->CheckIfDirectInstall())
+	{
+		InstallDirect();
+		return;
+	}
+
 	UpdateLoadingScreen(L"Copying files...");
 	/* for every "inner" path, go through and find the needed files */
 	for (std::wstring path : InsidePaths)
@@ -367,7 +541,7 @@ void ModInfo::StandardModProcess()
 		try
 		{
 			/* copy all files from root (any readme/extra info files) */
-			std::filesystem::copy(rootFrom, rootTo, std::filesystem::copy_options::overwrite_existing);
+			TreeCopier::InstallTree(rootFrom, rootTo, false, GetOwnerKey());
 
 			for (std::wstring subdirectory : ModSubDirectories)
 			{
@@ -376,7 +550,7 @@ void ModInfo::StandardModProcess()
 
 				NosLib::Logging::CreateLog<wchar_t>(std::format(L"Copying \"{}\" To \"{}\"", subRootFrom, subRootTo), NosLib::Logging::Severity::Info);
 
-				copyIfExists(subRootFrom, subRootTo);
+				copyIfExists(subRootFrom, subRootTo, GetOwnerKey());
 
 				NosLib::Logging::CreateLog<wchar_t>(std::format(L"Copied \"{}\" To \"{}\"", subRootFrom, subRootTo), NosLib::Logging::Severity::Info);
 			}
@@ -400,6 +574,13 @@ void ModInfo::CustomModProcess()
 		LogError(L"Failed to Get Mod File", std::source_location::current());
 	}
 
+	/* archive was never extracted, write the files straight into place */
+	if (FileObject->CheckIfDirectInstall())
+	{
+		InstallDirect();
+		return;
+	}
+
 	UpdateLoadingScreen(L"Copying files...");
 	/* for every "inner" path, go through and find the needed files */
 	for (std::wstring path : InsidePaths)
@@ -416,9 +597,9 @@ void ModInfo::CustomModProcess()
 		try
 		{
 			/* copy all files from root (any readme/extra info files) */
-			std::filesystem::copy(rootFrom, rootTo, std::filesystem::copy_options::overwrite_existing);
+			TreeCopier::InstallTree(rootFrom, rootTo, false, GetOwnerKey());
 
-			copyIfExists(rootFrom, rootTo);
+			copyIfExists(rootFrom, rootTo, GetOwnerKey());
 			NosLib::Logging::CreateLog<wchar_t>(std::format(L"Copied \"{}\" To \"{}\"", rootFrom, rootTo), NosLib::Logging::Severity::Info);
 		}
 		catch (const std::exception& ex)
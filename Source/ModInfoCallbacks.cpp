@@ -7,7 +7,8 @@ void ModInfo::InitialResponseCallback(const std::wstring& statusString)
 
 bool ModInfo::ProgressCallback(uint64_t len, uint64_t total)
 {
-	UpdateLoadingScreen((len * 100) / total);
+	/* total is 0 for chunked transfers, the slot handles that */
+	UpdateLoadingScreen(len, total);
 
 	return true;
 }
\ No newline at end of file
@@ -0,0 +1,267 @@
+#include "../Headers/ModpackUpdate.hpp"
+
+#include "../Headers/ModInfo.hpp"
+#include "../Headers/InstallOptions.hpp"
+#include "../Headers/InstallManifest.hpp"
+
+#include <NosLib/Logging.hpp>
+#include <NosLib/String.hpp>
+
+#include <fstream>
+#include <filesystem>
+#include <format>
+#include <unordered_map>
+#include <vector>
+
+bool ModpackUpdate::CanUpdate(const std::wstring& installPath)
+{
+	return std::filesystem::exists(installPath + InstalledListName);
+}
+
+std::unordered_set<std::wstring> ModpackUpdate::FindChangedFiles(const std::wstring& installPath, NosLib::DynamicArray<ModInfo*>& mods)
+{
+	std::unordered_map<std::wstring, File::Version> installedVersions;
+	{
+		std::ifstream versionList(installPath + VersionListName, std::ios::binary);
+
+		std::string line;
+		while (std::getline(versionList, line))
+		{
+			size_t eTagStart = line.find('\t');
+			size_t lastModifiedStart = (eTagStart == std::string::npos ? std::string::npos : line.find('\t', eTagStart + 1));
+
+			if (lastModifiedStart == std::string::npos)
+			{
+				continue;
+			}
+
+			installedVersions[NosLib::String::ToWstring(line.substr(0, eTagStart))] = { line.substr(eTagStart + 1, lastModifiedStart - eTagStart - 1), line.substr(lastModifiedStart + 1) };
+		}
+	}
+
+	std::unordered_set<std::wstring> changedOwners;
+	for (ModInfo* mod : mods)
+	{
+		auto installed = installedVersions.find(mod->GetOwnerKey());
+
+		if (installed == installedVersions.end() || mod->GetFileObject() == nullptr || !mod->GetFileObject()->CheckIfUnchanged(installed->second))
+		{
+			changedOwners.insert(mod->GetOwnerKey());
+			continue;
+		}
+
+		mod->SetInstalledVersion(installed->second);
+	}
+
+	NosLib::Logging::CreateLog<wchar_t>(std::format(L"Update: {} of {} files from outside the modpack list changed", changedOwners.size(), mods.GetItemCount()), NosLib::Logging::Severity::Info);
+	return changedOwners;
+}
+
+void ModpackUpdate::ApplyDiff(const std::wstring& installPath, NosLib::DynamicArray<ModInfo*>& parsedMods, const std::unordered_set<std::wstring>& forceInstall)
+{
+	std::wstring modDirectory = installPath + InstallInfo::ModDirectory;
+
+	/* folder name of every mod in the recorded list, the prefix is its position in the list (same counting as ModPrefixIndexCounter) */
+	std::unordered_map<std::wstring, std::wstring> installedFolders;
+	{
+		std::wifstream installedList(installPath + InstalledListName, std::ios::binary);
+
+		int prefixIndex = 1;
+		std::wstring line;
+		while (std::getline(installedList, line))
+		{
+			NosLib::DynamicArray<std::wstring> wordArray(6, 2);
+			NosLib::DynamicArray<std::wstring> pathArray(5, 5);
+
+			bool isMod = ModInfo::SplitLine(line, &wordArray, &pathArray);
+			std::wstring folderName = (isMod ? std::format(L"{}- {} {}", prefixIndex, wordArray[3], wordArray[2]) : std::format(L"{}- {}_separator", prefixIndex, wordArray[0]));
+
+			installedFolders[ModInfo::MakeUpdateKey(wordArray, pathArray, !isMod)] = folderName;
+			prefixIndex++;
+		}
+	}
+
+	/* these never finished installing, their folder (if there is one) is incomplete */
+	std::unordered_set<std::wstring> failedKeys;
+	{
+		std::ifstream failedList(installPath + FailedListName, std::ios::binary);
+
+		std::string line;
+		while (std::getline(failedList, line))
+		{
+			failedKeys.insert(NosLib::String::ToWstring(line));
+		}
+	}
+
+	struct FolderMove
+	{
+		ModInfo* Mod;
+		std::wstring From;
+		std::wstring To;
+		std::wstring CurrentFolder;	/* where the folder is after the renames, only To if both succeeded */
+	};
+
+	std::vector<ModInfo*> keptMods;
+	std::vector<FolderMove> moves;
+	int installCount = 0;
+
+	for (ModInfo* mod : parsedMods)
+	{
+		auto installed = installedFolders.find(mod->GetUpdateKey());
+
+		if (installed == installedFolders.end() || failedKeys.contains(mod->GetUpdateKey()) || forceInstall.contains(mod->GetOwnerKey()))
+		{
+			installCount++;
+			continue;
+		}
+
+		/* folder was deleted by hand, install it again */
+		if (!std::filesystem::exists(modDirectory + installed->second))
+		{
+			installedFolders.erase(installed);
+			installCount++;
+			continue;
+		}
+
+		/* same mod with the same files, only its position might have changed */
+		if (installed->second != mod->GetFolderName())
+		{
+			moves.push_back({ mod, installed->second, mod->GetFolderName(), installed->second });
+		}
+		else
+		{
+			keptMods.push_back(mod);
+		}
+
+		installedFolders.erase(installed);
+	}
+
+	std::error_code ec;
+
+	/* whatever is left was removed from the modpack, or changed (changed mods get installed fresh under their new key) */
+	for (auto& [key, folderName] : installedFolders)
+	{
+		std::filesystem::remove_all(modDirectory + folderName, ec);
+		InstallManifest::RemoveDirectory(modDirectory + folderName + L"\\");
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"Removed old mod folder \"{}\"", folderName), NosLib::Logging::Severity::Info);
+	}
+
+	/* renames go through a temporary name first, a mod can move into the folder name another kept mod is moving out of */
+	for (FolderMove& move : moves)
+	{
+		std::filesystem::rename(modDirectory + move.From, modDirectory + move.To + L".update", ec);
+		if (ec)
+		{
+			NosLib::Logging::CreateLog<wchar_t>(std::format(L"error: \"{}\" When trying to move \"{}\"", NosLib::String::ToWstring(ec.message()), move.From), NosLib::Logging::Severity::Error);
+			continue;
+		}
+
+		move.CurrentFolder = move.To + L".update";
+	}
+
+	for (FolderMove& move : moves)
+	{
+		if (move.CurrentFolder == move.From)
+		{
+			continue;
+		}
+
+		std::filesystem::rename(modDirectory + move.CurrentFolder, modDirectory + move.To, ec);
+		if (ec)
+		{
+			NosLib::Logging::CreateLog<wchar_t>(std::format(L"error: \"{}\" When trying to move \"{}\" to \"{}\"", NosLib::String::ToWstring(ec.message()), move.From, move.To), NosLib::Logging::Severity::Error);
+			continue;
+		}
+
+		move.CurrentFolder = move.To;
+	}
+
+	/* only mods which ended up in their new folder are kept, the others get installed fresh and whatever is left of their old folder goes */
+	int movedCount = 0;
+	for (FolderMove& move : moves)
+	{
+		if (move.CurrentFolder != move.To)
+		{
+			std::filesystem::remove_all(modDirectory + move.CurrentFolder, ec);
+			InstallManifest::RemoveDirectory(modDirectory + move.From + L"\\");
+			installCount++;
+			continue;
+		}
+
+		InstallManifest::MoveDirectory(modDirectory + move.From + L"\\", modDirectory + move.To + L"\\");
+		keptMods.push_back(move.Mod);
+		movedCount++;
+	}
+
+	for (ModInfo* mod : keptMods)
+	{
+		mod->MarkUpToDate();
+	}
+
+	NosLib::Logging::CreateLog<wchar_t>(std::format(L"Update: keeping {} mods ({} moved), installing {}, removing {}", keptMods.size(), movedCount, installCount, installedFolders.size()), NosLib::Logging::Severity::Info);
+}
+
+void ModpackUpdate::RecordInstalledList(const std::wstring& installPath, const std::wstring& modpackMakerListPath, NosLib::DynamicArray<ModInfo*>& mods)
+{
+	std::string failedContent;
+	int failedCount = 0;
+	for (ModInfo* mod : mods)
+	{
+		/* only modpack maker mods are in the list */
+		if (mod->GetUpdateKey().empty() || mod->CheckIfInstalled())
+		{
+			continue;
+		}
+
+		failedContent += NosLib::String::ToString(mod->GetUpdateKey()) + "\n";
+		failedCount++;
+	}
+
+	/* written first, a list without its failures would make the next update keep broken mods */
+	std::error_code ec;
+	if (failedCount == 0)
+	{
+		std::filesystem::remove(installPath + FailedListName, ec);
+	}
+	else
+	{
+		std::ofstream failedList(installPath + FailedListName, std::ios::binary | std::ios::trunc);
+		failedList << failedContent;
+
+		if (!failedList.good())
+		{
+			NosLib::Logging::CreateLog<wchar_t>(L"Failed to record the mods which failed to install, not recording the installed modpack list", NosLib::Logging::Severity::Error);
+			return;
+		}
+
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"{} mods failed to install, the next update installs them again", failedCount), NosLib::Logging::Severity::Warning);
+	}
+
+	/* mods from outside of the list can only be kept if it's known what version got installed */
+	std::string versionContent;
+	for (ModInfo* mod : mods)
+	{
+		if (!mod->GetUpdateKey().empty() || !mod->CheckIfInstalled() || !mod->GetInstalledVersion().IsKnown())
+		{
+			continue;
+		}
+
+		versionContent += std::format("{}\t{}\t{}\n", NosLib::String::ToString(mod->GetOwnerKey()), mod->GetInstalledVersion().ETag, mod->GetInstalledVersion().LastModified);
+	}
+
+	{
+		std::ofstream versionList(installPath + VersionListName, std::ios::binary | std::ios::trunc);
+		versionList << versionContent;
+
+		if (!versionList.good())
+		{
+			NosLib::Logging::CreateLog<wchar_t>(L"Failed to record the installed versions, the next update installs the setup files again", NosLib::Logging::Severity::Warning);
+		}
+	}
+
+	std::filesystem::copy_file(modpackMakerListPath, installPath + InstalledListName, std::filesystem::copy_options::overwrite_existing, ec);
+	if (ec)
+	{
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"error: \"{}\" When trying to record the installed modpack list", NosLib::String::ToWstring(ec.message())), NosLib::Logging::Severity::Error);
+	}
+}
@@ -0,0 +1,141 @@
+#include "../Headers/TreeCopier.hpp"
+
+#include "../Headers/FileLinking.hpp"
+
+#include <NosLib/Logging.hpp>
+
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <algorithm>
+#include <chrono>
+#include <format>
+
+void TreeCopier::CollectJobs(const std::filesystem::path& from, const std::filesystem::path& to, const bool& recursive, std::vector<FileJob>* jobs)
+{
+	std::filesystem::create_directories(to);
+
+	/* directory_entry caches what the walk already found out, so files don't get stat-ed again */
+	auto addEntry = [&](const std::filesystem::directory_entry& entry, const std::filesystem::path& target)
+	{
+		if (entry.is_directory())
+		{
+			/* walk is parents first, so the parent always exists already */
+			std::filesystem::create_directory(target);
+			return;
+		}
+
+		std::error_code ec;
+		uint64_t size = entry.file_size(ec);
+		jobs->emplace_back(entry.path(), target, (ec ? 0 : size));
+	};
+
+	if (!recursive)
+	{
+		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(from))
+		{
+			if (!entry.is_directory())
+			{
+				addEntry(entry, to / entry.path().filename());
+			}
+		}
+		return;
+	}
+
+	/* a trailing separator would make every relative path start with ".." */
+	std::filesystem::path root = (from.has_filename() ? from : from.parent_path());
+
+	for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(root))
+	{
+		addEntry(entry, to / entry.path().lexically_relative(root));
+	}
+}
+
+void TreeCopier::RunJobs(const std::vector<FileJob>& jobs, const std::wstring& owner)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	std::atomic<size_t> nextJob = 0;
+	std::atomic<bool> failed = false;
+	std::exception_ptr firstError;
+	std::mutex errorMutex;
+
+	auto worker = [&]()
+	{
+		for (size_t i = nextJob++; i < jobs.size() && !failed.load(); i = nextJob++)
+		{
+			try
+			{
+				FileLinking::InstallFile(jobs[i].From, jobs[i].To, owner);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lk(errorMutex);
+				if (!failed.exchange(true))
+				{
+					firstError = std::current_exception();
+				}
+			}
+		}
+	};
+
+	size_t wantedWorkers = jobs.size() / FilesPerWorker;
+	int workerCount = (wantedWorkers < WorkerCount ? static_cast<int>(wantedWorkers) : WorkerCount);
+
+	/* the calling thread is a worker too */
+	std::vector<std::thread> workers;
+	for (int i = 1; i < workerCount; i++)
+	{
+		workers.emplace_back(worker);
+	}
+
+	worker();
+
+	for (std::thread& workerThread : workers)
+	{
+		workerThread.join();
+	}
+
+	/* same as the serial copy, the mod gets told about the first file which failed */
+	if (firstError)
+	{
+		std::rethrow_exception(firstError);
+	}
+
+	/* what the worker pool actually gains can be compared between trees (and worker counts) from the log */
+	if (!jobs.empty())
+	{
+		uint64_t totalBytes = 0;
+		for (const FileJob& job : jobs)
+		{
+			totalBytes += job.Size;
+		}
+
+		uint64_t elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+		NosLib::Logging::CreateLog<wchar_t>(std::format(L"Installed {} files ({}KB) with {} workers in {}ms",
+														jobs.size(), totalBytes / 1024, (workerCount < 1 ? 1 : workerCount), elapsedMs),
+											NosLib::Logging::Severity::Debug);
+	}
+}
+
+void TreeCopier::InstallTree(const std::filesystem::path& from, const std::filesystem::path& to, const bool& recursive, const std::wstring& owner)
+{
+	/* single file gets put into the target directory, same as std::filesystem::copy */
+	if (std::filesystem::is_regular_file(from))
+	{
+		FileLinking::InstallFile(from, (std::filesystem::is_directory(to) ? to / from.filename() : to), owner);
+		return;
+	}
+
+	std::vector<FileJob> jobs;
+	CollectJobs(from, to, recursive, &jobs);
+
+	/* large .dds/.ogg files first, so 1 of them doesn't end up alone at the end while the other workers sit idle */
+	std::sort(jobs.begin(), jobs.end(), [](const FileJob& left, const FileJob& right)
+	{
+		return left.Size > right.Size;
+	});
+
+	RunJobs(jobs, owner);
+}
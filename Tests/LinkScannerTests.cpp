@@ -0,0 +1,61 @@
+#include "../Headers/LinkScanner.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+/* feeds the page in chunks of chunkSize, like httplib hands it over while downloading */
+static std::vector<std::string> scan(const std::string& page, const size_t& chunkSize, const std::string& anchorId = "", const bool& firstOnly = false)
+{
+	LinkScanner scanner(anchorId, firstOnly);
+
+	for (size_t position = 0; position < page.size(); position += chunkSize)
+	{
+		if (!scanner.Feed(page.data() + position, (chunkSize < page.size() - position ? chunkSize : page.size() - position)))
+		{
+			break;
+		}
+	}
+
+	return scanner.GetLinks();
+}
+
+static int failures = 0;
+
+static void expectLinks(const std::string& name, const std::string& page, const std::vector<std::string>& expected, const std::string& anchorId = "", const bool& firstOnly = false)
+{
+	/* every chunk size, so a tag (or a "<") split between chunks gets covered too */
+	for (size_t chunkSize = 1; chunkSize <= page.size(); chunkSize++)
+	{
+		if (scan(page, chunkSize, anchorId, firstOnly) != expected)
+		{
+			std::cerr << "FAILED: " << name << " (chunks of " << chunkSize << ")\n";
+			failures++;
+			return;
+		}
+	}
+}
+
+int main()
+{
+	expectLinks("plain link", "<html><a href=\"/one\">1</a></html>", { "/one" });
+	expectLinks("quote styles", "<a href='/one'>1</a><a href=/two>2</a><A HREF=\"/three\">3</A>", { "/one", "/two", "/three" });
+	expectLinks("entities", "<a href=\"/get?a=1&amp;b=2\">x</a>", { "/get?a=1&b=2" });
+	expectLinks("anchor id", "<a href=\"/other\">x</a><a id=\"downloadmirrorstoggle\" href=\"/mirror\">y</a>", { "/mirror" }, "downloadmirrorstoggle", true);
+	expectLinks("script skipped", "<script>var a = '<a href=\"/fake\">';</script><a href=\"/real\">x</a>", { "/real" });
+	expectLinks("comment skipped", "<!-- <a href=\"/fake\"> --><a href=\"/real\">x</a>", { "/real" });
+
+	/* a "<" in text used to start a tag, the "'" after it then swallowed the rest of the page */
+	expectLinks("less than in text", "<p>3 < 4 isn't</p><a href=\"/good\">x</a>", { "/good" });
+	expectLinks("less than before a quote", "<p>a <' b</p><a href=\"/good\">x</a>", { "/good" });
+	expectLinks("less than at the end", "<a href=\"/good\">x</a> 1 <", { "/good" });
+
+	if (failures != 0)
+	{
+		std::cerr << failures << " LinkScanner tests failed\n";
+		return 1;
+	}
+
+	std::cout << "LinkScanner tests passed\n";
+	return 0;
+}
@@ -1,6 +1,7 @@
 ﻿#include <QtWidgets/QApplication>
 #include <QFile>
 #include "InstallerWindow/InstallerWindow.hpp"
+#include "Headers/HeadlessInstall.hpp"
 
 #include <NosLib/Logging.hpp>
 #include <NosLib/HttpClient.hpp>
@@ -25,6 +26,14 @@ int main(int argc, char* argv[])
 	NosLib::Logging::SetVerboseLevel(NosLib::Logging::Verbose::Error);
 	NosLib::HttpClient::SetUserAgent("NCGI");
 
+	/* "--headless" runs the install straight from the arguments, without a window */
+	if (HeadlessInstall::IsRequested(argc, argv))
+	{
+		int exitCode = HeadlessInstall::Run(argc, argv);
+		SetThreadExecutionState(ES_CONTINUOUS);
+		return exitCode;
+	}
+
 	QApplication app(argc, argv);
 	app.setStyleSheet(GetStyleSheet());
 	app.setWindowIcon(QIcon(":/Icon/icon.ico"));